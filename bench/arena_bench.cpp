@@ -0,0 +1,151 @@
+/*
+Compares building and tearing down a WorkflowGraph, whose jobs live in an arena,
+against the previous allocation pattern where every Job and Communication was a
+separate heap object deleted one by one. The bulk row builds the same graph with
+reserve() and a single addCommunications() call on job ids.
+
+Usage: arena_bench [number of jobs] [communications per job]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "all.h"
+
+/**
+ * Reproduces the allocation pattern of WorkflowGraph before it used an arena:
+ * one new per Job and per Communication, and one delete per object on teardown.
+ */
+class HeapWorkflowGraph {
+private:
+    struct HeapJob {
+        std::string name;
+        int executionTime;
+        HeapJob(std::string _name, int _executionTime): name(_name), executionTime(_executionTime) {}
+    };
+    struct HeapCommunication {
+        HeapJob* fromJob;
+        HeapJob* toJob;
+        int commTime;
+        HeapCommunication(HeapJob* _fromJob, HeapJob* _toJob, int _commTime): fromJob(_fromJob), toJob(_toJob), commTime(_commTime) {}
+    };
+
+    std::unordered_map<std::string, HeapJob*> jobs;
+    std::unordered_map<HeapJob*, std::vector<HeapCommunication*>> inCommunications;
+    std::unordered_map<HeapJob*, std::vector<HeapCommunication*>> outCommunications;
+public:
+    ~HeapWorkflowGraph() {
+        for (auto& job: jobs) {
+            delete job.second;
+        }
+        for (auto& cpair: outCommunications) {
+            for (auto& comm: cpair.second) {
+                delete comm;
+            }
+        }
+    }
+
+    void addJob(std::string name, int executionTime) {
+        jobs[name] = new HeapJob(name, executionTime);
+        inCommunications[jobs[name]] = std::vector<HeapCommunication*>();
+        outCommunications[jobs[name]] = std::vector<HeapCommunication*>();
+    }
+
+    void addCommunication(std::string fromJobName, std::string toJobName, int commTime) {
+        HeapCommunication* newCommunication = new HeapCommunication(jobs[fromJobName], jobs[toJobName], commTime);
+        inCommunications[jobs[toJobName]].emplace_back(newCommunication);
+        outCommunications[jobs[fromJobName]].emplace_back(newCommunication);
+    }
+};
+
+/**
+ * @return Seconds elapsed since start
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Builds a random DAG into a freshly allocated graph, then destroys it, timing both phases.
+ * Edges always point from a lower to a higher job index so the result is acyclic.
+ * @param names Job names
+ * @param edges Pairs of job indices
+ * @param buildSeconds Receives the build time
+ * @param teardownSeconds Receives the teardown time
+ */
+template <class Graph>
+static void run(const std::vector<std::string>& names, const std::vector<std::pair<int, int>>& edges,
+                double& buildSeconds, double& teardownSeconds) {
+    auto start = std::chrono::steady_clock::now();
+    Graph* graph = new Graph();
+    for (size_t i = 0; i < names.size(); i++) {
+        graph->addJob(names[i], 1 + i % 7);
+    }
+    for (const auto& edge: edges) {
+        graph->addCommunication(names[edge.first], names[edge.second], 1 + edge.second % 5);
+    }
+    buildSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    delete graph;
+    teardownSeconds = secondsSince(start);
+}
+
+/**
+ * Same as run() but sizes the graph up front and ingests the edge list as arrays of job ids.
+ */
+static void runBulk(const std::vector<std::string>& names, const std::vector<std::pair<int, int>>& edges,
+                    double& buildSeconds, double& teardownSeconds) {
+    std::vector<JobId> fromJobs, toJobs;
+    std::vector<int> commTimes;
+    for (const auto& edge: edges) {
+        fromJobs.emplace_back(edge.first);
+        toJobs.emplace_back(edge.second);
+        commTimes.emplace_back(1 + edge.second % 5);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    WorkflowGraph* graph = new WorkflowGraph();
+    graph->reserve(names.size(), edges.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        graph->addJob(names[i], 1 + i % 7);
+    }
+    graph->addCommunications(edges.size(), fromJobs.data(), toJobs.data(), commTimes.data());
+    buildSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    delete graph;
+    teardownSeconds = secondsSince(start);
+}
+
+int main(int argc, char** argv) {
+    int numJobs = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int degree = argc > 2 ? std::atoi(argv[2]) : 4;
+
+    std::vector<std::string> names;
+    for (int i = 0; i < numJobs; i++) {
+        names.emplace_back("job" + std::to_string(i));
+    }
+    std::vector<std::pair<int, int>> edges;
+    srand(1);
+    for (int i = 1; i < numJobs; i++) {
+        for (int d = 0; d < degree; d++) {
+            edges.emplace_back(rand() % i, i);
+        }
+    }
+
+    double heapBuild, heapTeardown, arenaBuild, arenaTeardown, bulkBuild, bulkTeardown;
+    run<HeapWorkflowGraph>(names, edges, heapBuild, heapTeardown);
+    run<WorkflowGraph>(names, edges, arenaBuild, arenaTeardown);
+    runBulk(names, edges, bulkBuild, bulkTeardown);
+
+    std::printf("%d jobs, %zu communications\n", numJobs, edges.size());
+    std::printf("%-8s %12s %12s\n", "", "build (s)", "teardown (s)");
+    std::printf("%-8s %12.3f %12.3f\n", "heap", heapBuild, heapTeardown);
+    std::printf("%-8s %12.3f %12.3f\n", "arena", arenaBuild, arenaTeardown);
+    std::printf("%-8s %12.3f %12.3f\n", "bulk", bulkBuild, bulkTeardown);
+    return 0;
+}
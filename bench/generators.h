@@ -0,0 +1,298 @@
+#pragma once
+
+/*
+Synthetic workflow generators shared by the benchmarks. Every generator lays out
+the dependencies of a well-known DAG family, then draws execution times around a
+mean and communication times scaled so that the average communication time over
+the average execution time is the requested communication-to-computation ratio
+(CCR).
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "all.h"
+
+// DAG families the benchmarks are run on.
+enum class GraphFamily {
+    Layered,            ///< Random layered DAG, every job depending on random jobs of the previous layer
+    ForkJoin,           ///< Stages where one job forks into parallel jobs that join into the next stage
+    GaussianElimination,///< Task graph of Gaussian elimination on a matrix, one pivot and its row updates per step
+    Fft,                ///< Task graph of the recursive FFT, a binary tree of calls followed by butterfly levels
+    Montage,            ///< Like the Montage astronomy mosaic workflow, a wide fan-in, fan-out and fan-in
+    Chain               ///< Single chain of jobs, the deepest possible DAG
+};
+
+static const char* const GRAPH_FAMILY_NAMES[] = {"layered", "forkjoin", "gauss", "fft", "montage", "chain"};
+
+// Parameters of a synthetic workflow.
+struct GeneratorOptions {
+    size_t numJobs = 100000;        ///< Approximate number of jobs, the exact one depends on the family
+    double degree = 2.0;            ///< Average number of predecessors of a job, used by the layered family only
+    double ccr = 1.0;               ///< Communication-to-computation ratio
+    int meanExecutionTime = 100;    ///< Mean execution time of a job
+    uint32_t seed = 1;              ///< Seed of the random times and dependencies
+};
+
+// Jobs and communications of a synthetic workflow, as the parallel arrays the CSR form is built from.
+struct SyntheticWorkflow {
+    std::vector<int> executionTimes;    ///< Execution time of every job
+    std::vector<JobId> fromJobs;        ///< Source job of every communication
+    std::vector<JobId> toJobs;          ///< Destination job of every communication
+    std::vector<int> commTimes;         ///< Communication time of every communication
+
+    /**
+     * Adds a job.
+     * @return Id of the job
+     */
+    JobId addJob() {
+        executionTimes.emplace_back(0);
+        return executionTimes.size() - 1;
+    }
+
+    /**
+     * Adds a communication.
+     * @param fromJob Job producing the data
+     * @param toJob Job consuming the data
+     */
+    void addCommunication(JobId fromJob, JobId toJob) {
+        fromJobs.emplace_back(fromJob);
+        toJobs.emplace_back(toJob);
+        commTimes.emplace_back(0);
+    }
+
+    /**
+     * @return Frozen graph of the workflow
+     */
+    CSRWorkflowGraph freeze() const {
+        return CSRWorkflowGraph(executionTimes.size(), executionTimes.data(), commTimes.size(), fromJobs.data(),
+                                toJobs.data(), commTimes.data());
+    }
+};
+
+/**
+ * Draws execution times uniformly in [1, 2 * mean - 1] and communication times uniformly in [0, 2 * mean * CCR].
+ * @param workflow Workflow whose times are drawn
+ * @param options Mean execution time and CCR
+ * @param rng Random generator
+ */
+inline void drawTimes(SyntheticWorkflow& workflow, const GeneratorOptions& options, std::mt19937& rng) {
+    std::uniform_int_distribution<int> executionTime(1, std::max(1, 2 * options.meanExecutionTime - 1));
+    std::uniform_int_distribution<int> commTime(0, static_cast<int>(std::lround(2 * options.meanExecutionTime * options.ccr)));
+    for (int& time: workflow.executionTimes) {
+        time = executionTime(rng);
+    }
+    for (int& time: workflow.commTimes) {
+        time = commTime(rng);
+    }
+}
+
+/**
+ * Random layered DAG with about sqrt(V) jobs per layer, where every job outside the first layer depends on about
+ * `degree` distinct random jobs of the previous layer.
+ */
+inline void generateLayered(SyntheticWorkflow& workflow, const GeneratorOptions& options, std::mt19937& rng) {
+    size_t width = std::max<size_t>(1, std::sqrt(static_cast<double>(options.numJobs)));
+    size_t wholeDegree = static_cast<size_t>(options.degree);
+    std::bernoulli_distribution extraEdge(options.degree - wholeDegree);
+    std::vector<JobId> predecessors;
+    for (size_t job = 0; job < options.numJobs; job++) {
+        workflow.addJob();
+        if (job < width) {
+            continue;
+        }
+        size_t layerStart = job / width * width, previousStart = layerStart - width;
+        size_t degree = std::min(width, wholeDegree + extraEdge(rng));
+        predecessors.clear();
+        while (predecessors.size() < degree) {
+            JobId predecessor = previousStart + rng() % width;
+            if (std::find(predecessors.begin(), predecessors.end(), predecessor) == predecessors.end()) {
+                predecessors.emplace_back(predecessor);
+                workflow.addCommunication(predecessor, job);
+            }
+        }
+    }
+}
+
+/**
+ * Fork-join stages of about sqrt(V) parallel jobs, each stage forking from the join of the previous one.
+ */
+inline void generateForkJoin(SyntheticWorkflow& workflow, const GeneratorOptions& options) {
+    size_t width = std::max<size_t>(1, std::sqrt(static_cast<double>(options.numJobs)));
+    size_t numStages = std::max<size_t>(1, (options.numJobs - 1) / (width + 1));
+    JobId join = workflow.addJob();
+    for (size_t stage = 0; stage < numStages; stage++) {
+        JobId fork = join;
+        JobId firstParallel = workflow.executionTimes.size();
+        for (size_t i = 0; i < width; i++) {
+            workflow.addCommunication(fork, workflow.addJob());
+        }
+        join = workflow.addJob();
+        for (size_t i = 0; i < width; i++) {
+            workflow.addCommunication(firstParallel + i, join);
+        }
+    }
+}
+
+/**
+ * Gaussian elimination on an m x m matrix, with (m^2 + m - 2) / 2 jobs. Step k has a pivot job followed by the update
+ * of every column j > k, which depends on the pivot and on the update of column j in step k - 1.
+ */
+inline void generateGaussianElimination(SyntheticWorkflow& workflow, const GeneratorOptions& options) {
+    size_t m = 2;
+    while ((m + 1) * (m + 1) + (m + 1) - 2 <= 2 * options.numJobs) {
+        m++;
+    }
+    std::vector<JobId> previousUpdates(m + 1, 0);  // update of every column in the previous step
+    for (size_t k = 1; k < m; k++) {
+        JobId pivot = workflow.addJob();
+        if (k > 1) {
+            workflow.addCommunication(previousUpdates[k], pivot);
+        }
+        for (size_t j = k + 1; j <= m; j++) {
+            JobId update = workflow.addJob();
+            workflow.addCommunication(pivot, update);
+            if (k > 1) {
+                workflow.addCommunication(previousUpdates[j], update);
+            }
+            previousUpdates[j] = update;
+        }
+    }
+}
+
+/**
+ * Recursive FFT on n points, n a power of two, with 2n - 1 + n log2(n) jobs: a binary tree of recursive calls whose
+ * n leaves start log2(n) levels of butterfly operations, where job i of level l + 1 depends on jobs i and i xor 2^l
+ * of level l.
+ */
+inline void generateFft(SyntheticWorkflow& workflow, const GeneratorOptions& options) {
+    size_t n = 2, logN = 1;
+    while (2 * (2 * n) - 1 + 2 * n * (logN + 1) <= options.numJobs) {
+        n *= 2;
+        logN++;
+    }
+    std::vector<JobId> level(1, workflow.addJob());
+    while (level.size() < n) {
+        std::vector<JobId> children;
+        for (JobId call: level) {
+            for (int c = 0; c < 2; c++) {
+                children.emplace_back(workflow.addJob());
+                workflow.addCommunication(call, children.back());
+            }
+        }
+        level.swap(children);
+    }
+    for (size_t l = 0; l < logN; l++) {
+        std::vector<JobId> butterflies(n);
+        for (size_t i = 0; i < n; i++) {
+            butterflies[i] = workflow.addJob();
+            workflow.addCommunication(level[i], butterflies[i]);
+            workflow.addCommunication(level[i ^ (size_t(1) << l)], butterflies[i]);
+        }
+        level.swap(butterflies);
+    }
+}
+
+/**
+ * Montage-like mosaic of a square grid of n images: every image is projected, every pair of neighboring projections
+ * is differenced, all differences are fitted and concatenated into a background model, every projection is corrected
+ * with the model, and the corrected images are tabled, added, shrunk and rendered.
+ */
+inline void generateMontage(SyntheticWorkflow& workflow, const GeneratorOptions& options) {
+    size_t side = std::max<size_t>(2, std::sqrt(options.numJobs / 4.0));
+    size_t n = side * side;
+    std::vector<JobId> projections(n);
+    for (JobId& projection: projections) {
+        projection = workflow.addJob();
+    }
+    JobId concatFit = workflow.addJob();
+    for (size_t i = 0; i < n; i++) {
+        size_t neighbors[] = {i % side + 1 < side ? i + 1 : n, i + side};
+        for (size_t neighbor: neighbors) {
+            if (neighbor < n) {
+                JobId diffFit = workflow.addJob();
+                workflow.addCommunication(projections[i], diffFit);
+                workflow.addCommunication(projections[neighbor], diffFit);
+                workflow.addCommunication(diffFit, concatFit);
+            }
+        }
+    }
+    JobId bgModel = workflow.addJob();
+    workflow.addCommunication(concatFit, bgModel);
+    JobId imgTbl = workflow.addJob();
+    for (size_t i = 0; i < n; i++) {
+        JobId background = workflow.addJob();
+        workflow.addCommunication(projections[i], background);
+        workflow.addCommunication(bgModel, background);
+        workflow.addCommunication(background, imgTbl);
+    }
+    JobId previous = imgTbl;
+    for (int stage = 0; stage < 3; stage++) {  // mAdd, mShrink, mJPEG
+        JobId next = workflow.addJob();
+        workflow.addCommunication(previous, next);
+        previous = next;
+    }
+}
+
+/**
+ * Single chain of V jobs.
+ */
+inline void generateChain(SyntheticWorkflow& workflow, const GeneratorOptions& options) {
+    for (size_t job = 0; job < std::max<size_t>(1, options.numJobs); job++) {
+        workflow.addJob();
+        if (job > 0) {
+            workflow.addCommunication(job - 1, job);
+        }
+    }
+}
+
+/**
+ * Generates a synthetic workflow.
+ * @param family DAG family
+ * @param options Size, degree, CCR and seed
+ * @return The workflow
+ */
+inline SyntheticWorkflow generateWorkflow(GraphFamily family, const GeneratorOptions& options) {
+    std::mt19937 rng(options.seed);
+    SyntheticWorkflow workflow;
+    switch (family) {
+    case GraphFamily::Layered:
+        generateLayered(workflow, options, rng);
+        break;
+    case GraphFamily::ForkJoin:
+        generateForkJoin(workflow, options);
+        break;
+    case GraphFamily::GaussianElimination:
+        generateGaussianElimination(workflow, options);
+        break;
+    case GraphFamily::Fft:
+        generateFft(workflow, options);
+        break;
+    case GraphFamily::Montage:
+        generateMontage(workflow, options);
+        break;
+    default:
+        generateChain(workflow, options);
+    }
+    drawTimes(workflow, options, rng);
+    return workflow;
+}
+
+/**
+ * Looks up a DAG family by name.
+ * @param name Name of the family, as in GRAPH_FAMILY_NAMES
+ * @param family Set to the family if the name is one
+ * @return True if the name is a family, false otherwise
+ */
+inline bool parseGraphFamily(const std::string& name, GraphFamily& family) {
+    for (size_t i = 0; i < sizeof(GRAPH_FAMILY_NAMES) / sizeof(GRAPH_FAMILY_NAMES[0]); i++) {
+        if (name == GRAPH_FAMILY_NAMES[i]) {
+            family = static_cast<GraphFamily>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,442 @@
+/*
+Measures how good the schedules are, rather than how fast they are computed, on
+the synthetic DAG families at several communication-to-computation ratios (CCR)
+and on task graphs of the Standard Task Graph Set (STG) given as files. Every
+ordering and placement policy of WorkflowSchedule is compared against reference
+implementations of HEFT and CPOP [Topcuoglu et al. 2002], which evaluate every
+machine for every job with insertion into idle gaps.
+
+For every schedule it reports:
+  makespan
+  speedup     sum of all execution times / makespan
+  efficiency  speedup / number of machines
+  SLR         makespan / execution times along the critical path, a lower bound
+              on any schedule, so 1 is optimal (schedule length ratio)
+  bound       makespan / the larger of that critical path and the sum of all
+              execution times spread over all machines, a tighter lower bound
+and checks that dependencies, communication times and machine occupancy hold.
+The summary gives the mean SLR of every algorithm and how often it gave the
+shortest schedule.
+
+STG files list the number of tasks, then one line per task with its id, time,
+number of predecessors and their ids, including a dummy entry and exit task.
+They have no communication times, so they are drawn for the requested CCR.
+
+Usage: quality_bench [-n jobs] [-k machines] [-c ccr ...] [-g family ...] [STG file ...]
+  defaults: 2000 jobs, 8 machines, CCR 0.1, 1 and 10, all families
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <getopt.h>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include "generators.h"
+
+// A scheduling algorithm compared by the benchmark.
+struct Algorithm {
+    const char* name;               ///< Name in the report
+    bool isBaseline;                ///< Whether it is a reference implementation rather than WorkflowSchedule
+    OrderingPolicy orderingPolicy;  ///< Ordering policy of WorkflowSchedule
+    PlacementPolicy placementPolicy;///< Placement policy of WorkflowSchedule
+};
+
+static const Algorithm ALGORITHMS[] = {
+    {"static", false, OrderingPolicy::StaticCriticalPath, PlacementPolicy::Append},
+    {"static+ins", false, OrderingPolicy::StaticCriticalPath, PlacementPolicy::Insertion},
+    {"dls", false, OrderingPolicy::DynamicLevel, PlacementPolicy::Append},
+    {"etf", false, OrderingPolicy::EarliestTimeFirst, PlacementPolicy::Append},
+    {"heft", true, OrderingPolicy::StaticCriticalPath, PlacementPolicy::Insertion},
+    {"cpop", true, OrderingPolicy::StaticCriticalPath, PlacementPolicy::Insertion}
+};
+static const size_t NUM_ALGORITHMS = sizeof(ALGORITHMS) / sizeof(ALGORITHMS[0]);
+
+/**
+ * Machines of a reference scheduler, each with the sorted intervals its jobs run in, searched linearly for the
+ * earliest idle gap.
+ */
+class ReferenceMachines {
+private:
+    std::vector<std::vector<std::pair<int, int>>> intervals;  ///< Start and finish time of the jobs of every machine
+public:
+    explicit ReferenceMachines(int numMachines): intervals(numMachines) {}
+
+    /**
+     * @param machine The machine
+     * @param readyTime Time at which the data of the job is on the machine
+     * @param executionTime Execution time of the job
+     * @return Earliest start time of the job on the machine, in an idle gap or after its last job
+     */
+    int findStart(int machine, int readyTime, int executionTime) const {
+        int start = readyTime;
+        for (const auto& interval: intervals[machine]) {
+            if (start + executionTime <= interval.first) {
+                return start;
+            }
+            start = std::max(start, interval.second);
+        }
+        return start;
+    }
+
+    /**
+     * Runs a job on a machine.
+     * @param machine The machine
+     * @param start Start time of the job
+     * @param finish Finish time of the job
+     */
+    void occupy(int machine, int start, int finish) {
+        auto& machineIntervals = intervals[machine];
+        machineIntervals.insert(std::upper_bound(machineIntervals.begin(), machineIntervals.end(), std::make_pair(start, finish)),
+                                std::make_pair(start, finish));
+    }
+};
+
+/**
+ * Reference list scheduler shared by HEFT and CPOP: ready jobs are taken by decreasing priority, and every job goes to
+ * the machine where it finishes earliest with insertion, unless it is pinned to a machine.
+ * @param graph The workflow
+ * @param numMachines Number of machines
+ * @param priorities Priority of every job
+ * @param pinnedMachines Machine every job must run on, or -1 for any
+ * @return Pair containing the makespan and the jobs in the order they were placed
+ */
+static std::pair<int, ScheduleOrder> referenceListSchedule(const CSRWorkflowGraph& graph, int numMachines,
+                                                           const std::vector<int>& priorities,
+                                                           const std::vector<int>& pinnedMachines) {
+    size_t numJobs = graph.getNumJobs();
+    std::vector<int> inDegrees(numJobs), machines(numJobs), finishTimes(numJobs);
+    std::priority_queue<std::pair<int, int>> readyJobs;  // priority and negated id, so that lower ids go first on ties
+    for (JobId job = 0; job < numJobs; job++) {
+        inDegrees[job] = graph.getIndegree(job);
+        if (inDegrees[job] == 0) {
+            readyJobs.emplace(priorities[job], -static_cast<int>(job));
+        }
+    }
+
+    ReferenceMachines machineIntervals(numMachines);
+    ScheduleOrder scheduleOrder;
+    int makespan = 0;
+    while (!readyJobs.empty()) {
+        JobId job = -readyJobs.top().second;
+        readyJobs.pop();
+        int executionTime = graph.getExecutionTime(job);
+        int bestMachine = -1, bestStart = 0;
+        for (int machine = 0; machine < numMachines; machine++) {
+            if (pinnedMachines[job] >= 0 && machine != pinnedMachines[job]) {
+                continue;
+            }
+            int readyTime = 0;
+            for (const CSREdge& comm: graph.getInEdges(job)) {
+                readyTime = std::max(readyTime, finishTimes[comm.job] + (machines[comm.job] == machine ? 0 : comm.commTime));
+            }
+            int start = machineIntervals.findStart(machine, readyTime, executionTime);
+            if (bestMachine < 0 || start < bestStart) {
+                bestMachine = machine;
+                bestStart = start;
+            }
+        }
+        machines[job] = bestMachine;
+        finishTimes[job] = bestStart + executionTime;
+        machineIntervals.occupy(bestMachine, bestStart, finishTimes[job]);
+        scheduleOrder.emplace_back(job, bestMachine, bestStart, bestStart, finishTimes[job]);
+        makespan = std::max(makespan, finishTimes[job]);
+
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            if (--inDegrees[comm.job] == 0) {
+                readyJobs.emplace(priorities[comm.job], -static_cast<int>(comm.job));
+            }
+        }
+    }
+    return {makespan, scheduleOrder};
+}
+
+/**
+ * HEFT: jobs by decreasing upward rank, which is the critical weight, each on the machine finishing it earliest.
+ */
+static std::pair<int, ScheduleOrder> scheduleHeft(const CSRWorkflowGraph& graph, int numMachines) {
+    return referenceListSchedule(graph, numMachines, computeCriticalWeights(graph), std::vector<int>(graph.getNumJobs(), -1));
+}
+
+/**
+ * CPOP: jobs by decreasing sum of upward and downward rank. The jobs of a critical path, whose sum is the largest,
+ * all run on one machine, and the others on the machine finishing them earliest.
+ */
+static std::pair<int, ScheduleOrder> scheduleCpop(const CSRWorkflowGraph& graph, int numMachines) {
+    size_t numJobs = graph.getNumJobs();
+    std::vector<int> upwardRanks = computeCriticalWeights(graph);
+    std::vector<JobId> topOrder = WorkflowSchedule(&graph, 1).topologicalSort(upwardRanks);
+    std::vector<int> downwardRanks(numJobs, 0), priorities(numJobs);
+    for (JobId job: topOrder) {
+        for (const CSREdge& comm: graph.getInEdges(job)) {
+            downwardRanks[job] = std::max(downwardRanks[job], downwardRanks[comm.job] + graph.getExecutionTime(comm.job) + comm.commTime);
+        }
+    }
+    int criticalLength = 0;
+    JobId criticalJob = 0;
+    for (JobId job = 0; job < numJobs; job++) {
+        priorities[job] = upwardRanks[job] + downwardRanks[job];
+        if (graph.getIndegree(job) == 0 && priorities[job] > criticalLength) {
+            criticalLength = priorities[job];
+            criticalJob = job;
+        }
+    }
+
+    // follow the critical path from its entry job, pinning it to the machine that will run it
+    std::vector<int> pinnedMachines(numJobs, -1);
+    for (bool isOnPath = numJobs > 0; isOnPath;) {
+        pinnedMachines[criticalJob] = 0;
+        isOnPath = false;
+        for (const CSREdge& comm: graph.getOutEdges(criticalJob)) {
+            if (priorities[comm.job] == criticalLength) {
+                criticalJob = comm.job;
+                isOnPath = true;
+                break;
+            }
+        }
+    }
+    return referenceListSchedule(graph, numMachines, priorities, pinnedMachines);
+}
+
+/**
+ * Checks that a schedule runs every job once for its execution time, after the data of its predecessors arrived, and
+ * without overlapping another job of its machine.
+ * @param graph The workflow
+ * @param numMachines Number of machines
+ * @param result Makespan and scheduled jobs
+ * @return True if the schedule is valid, false otherwise
+ */
+static bool isValidSchedule(const CSRWorkflowGraph& graph, int numMachines, const std::pair<int, ScheduleOrder>& result) {
+    size_t numJobs = graph.getNumJobs();
+    if (result.second.size() != numJobs) {
+        return false;
+    }
+    std::vector<const ScheduledJob*> jobs(numJobs, nullptr);
+    std::vector<std::vector<std::pair<int, int>>> intervals(numMachines);
+    int makespan = 0;
+    for (const ScheduledJob& scheduledJob: result.second) {
+        if (scheduledJob.jobId >= numJobs || jobs[scheduledJob.jobId] != nullptr || scheduledJob.machineId < 0 ||
+            scheduledJob.machineId >= numMachines ||
+            scheduledJob.finishTime - scheduledJob.startTime != graph.getExecutionTime(scheduledJob.jobId)) {
+            return false;
+        }
+        jobs[scheduledJob.jobId] = &scheduledJob;
+        intervals[scheduledJob.machineId].emplace_back(scheduledJob.startTime, scheduledJob.finishTime);
+        makespan = std::max(makespan, scheduledJob.finishTime);
+    }
+    for (JobId job = 0; job < numJobs; job++) {
+        for (const CSREdge& comm: graph.getInEdges(job)) {
+            const ScheduledJob& predecessor = *jobs[comm.job];
+            int arrival = predecessor.finishTime + (predecessor.machineId == jobs[job]->machineId ? 0 : comm.commTime);
+            if (jobs[job]->startTime < arrival) {
+                return false;
+            }
+        }
+    }
+    for (auto& machineIntervals: intervals) {
+        std::sort(machineIntervals.begin(), machineIntervals.end());
+        for (size_t i = 1; i < machineIntervals.size(); i++) {
+            if (machineIntervals[i].first < machineIntervals[i - 1].second) {
+                return false;
+            }
+        }
+    }
+    return makespan == result.first;
+}
+
+/**
+ * @param graph The workflow
+ * @return Largest sum of execution times along a path, which no schedule can beat
+ */
+static long long getCriticalPathLength(const CSRWorkflowGraph& graph) {
+    size_t numJobs = graph.getNumJobs();
+    std::vector<long long> lengths(numJobs, 0);
+    std::vector<int> inDegrees(numJobs);
+    std::vector<JobId> readyJobs;
+    for (JobId job = 0; job < numJobs; job++) {
+        inDegrees[job] = graph.getIndegree(job);
+        if (inDegrees[job] == 0) {
+            readyJobs.emplace_back(job);
+        }
+    }
+    long long criticalLength = 0;
+    while (!readyJobs.empty()) {
+        JobId job = readyJobs.back();
+        readyJobs.pop_back();
+        lengths[job] += graph.getExecutionTime(job);
+        criticalLength = std::max(criticalLength, lengths[job]);
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            lengths[comm.job] = std::max(lengths[comm.job], lengths[job]);
+            if (--inDegrees[comm.job] == 0) {
+                readyJobs.emplace_back(comm.job);
+            }
+        }
+    }
+    return criticalLength;
+}
+
+/**
+ * Reads a task graph of the Standard Task Graph Set, drawing communication times for a CCR.
+ * @param path Path of the file
+ * @param options CCR and seed of the communication times
+ * @param workflow Receives the jobs and communications
+ * @return True if the file was read, false otherwise
+ */
+static bool readStgFile(const std::string& path, const GeneratorOptions& options, SyntheticWorkflow& workflow) {
+    std::ifstream in(path.c_str());
+    size_t numTasks;
+    if (!(in >> numTasks)) {
+        return false;
+    }
+    numTasks += 2;  // dummy entry and exit tasks
+    workflow.executionTimes.assign(numTasks, 0);
+    for (size_t i = 0; i < numTasks; i++) {
+        size_t task, numPredecessors, predecessor;
+        int time;
+        if (!(in >> task >> time >> numPredecessors) || task >= numTasks) {
+            return false;
+        }
+        workflow.executionTimes[task] = time;
+        for (size_t p = 0; p < numPredecessors; p++) {
+            if (!(in >> predecessor) || predecessor >= numTasks) {
+                return false;
+            }
+            workflow.addCommunication(predecessor, task);
+        }
+    }
+
+    long long totalTime = std::accumulate(workflow.executionTimes.begin(), workflow.executionTimes.end(), 0LL);
+    double meanTime = static_cast<double>(totalTime) / std::max<size_t>(1, numTasks - 2);
+    std::mt19937 rng(options.seed);
+    std::uniform_int_distribution<int> commTime(0, static_cast<int>(std::lround(2 * meanTime * options.ccr)));
+    for (int& time: workflow.commTimes) {
+        time = commTime(rng);
+    }
+    return true;
+}
+
+// Quality of the schedules of every algorithm, accumulated over all workflows.
+struct QualitySummary {
+    double slrSum[NUM_ALGORITHMS] = {};     ///< Sum of the SLR of every algorithm
+    int numBest[NUM_ALGORITHMS] = {};       ///< Number of workflows where the algorithm gave the shortest schedule
+    int numInvalid[NUM_ALGORITHMS] = {};    ///< Number of invalid schedules of every algorithm
+    int numWorkflows = 0;                   ///< Number of workflows
+};
+
+/**
+ * Schedules a workflow with every algorithm and reports the quality of the schedules.
+ * @param label Name of the workflow in the report
+ * @param ccr CCR of the workflow
+ * @param graph The workflow
+ * @param numMachines Number of machines
+ * @param summary Accumulates the quality over all workflows
+ */
+static void compareAlgorithms(const std::string& label, double ccr, const CSRWorkflowGraph& graph, int numMachines,
+                              QualitySummary& summary) {
+    long long totalTime = 0;
+    for (JobId job = 0; job < graph.getNumJobs(); job++) {
+        totalTime += graph.getExecutionTime(job);
+    }
+    double criticalLength = std::max<long long>(1, getCriticalPathLength(graph));
+    double lowerBound = std::max(criticalLength, static_cast<double>(totalTime) / numMachines);
+
+    int makespans[NUM_ALGORITHMS];
+    for (size_t a = 0; a < NUM_ALGORITHMS; a++) {
+        const Algorithm& algorithm = ALGORITHMS[a];
+        std::pair<int, ScheduleOrder> result;
+        if (!algorithm.isBaseline) {
+            WorkflowSchedule schedule(&graph, numMachines);
+            schedule.setOrderingPolicy(algorithm.orderingPolicy);
+            schedule.setPlacementPolicy(algorithm.placementPolicy);
+            result = schedule.schedule();
+        } else {
+            result = std::string(algorithm.name) == "heft" ? scheduleHeft(graph, numMachines) : scheduleCpop(graph, numMachines);
+        }
+        makespans[a] = result.first;
+
+        bool isValid = isValidSchedule(graph, numMachines, result);
+        double speedup = totalTime / std::max(1.0, static_cast<double>(result.first));
+        double slr = result.first / criticalLength;
+        summary.slrSum[a] += slr;
+        summary.numInvalid[a] += !isValid;
+        std::printf("%-12s %6zu %6.2f %-10s %10d %8.2f %10.3f %8.3f %8.3f%s\n", label.c_str(), graph.getNumJobs(), ccr,
+                    algorithm.name, result.first, speedup, speedup / numMachines, slr, result.first / lowerBound,
+                    isValid ? "" : "  INVALID");
+    }
+
+    int bestMakespan = *std::min_element(makespans, makespans + NUM_ALGORITHMS);
+    for (size_t a = 0; a < NUM_ALGORITHMS; a++) {
+        summary.numBest[a] += makespans[a] == bestMakespan;
+    }
+    summary.numWorkflows++;
+}
+
+int main(int argc, char** argv) {
+    GeneratorOptions options;
+    options.numJobs = 2000;
+    int numMachines = 8, opt;
+    std::vector<double> ccrs;
+    std::vector<GraphFamily> families;
+    while ((opt = getopt(argc, argv, "n:k:c:g:")) != -1) {
+        GraphFamily family;
+        switch (opt) {
+        case 'n':
+            options.numJobs = std::strtoull(optarg, nullptr, 10);
+            break;
+        case 'k':
+            numMachines = std::max(1, std::atoi(optarg));
+            break;
+        case 'c':
+            ccrs.emplace_back(std::strtod(optarg, nullptr));
+            break;
+        case 'g':
+            if (!parseGraphFamily(optarg, family)) {
+                std::fprintf(stderr, "quality_bench: unknown family '%s'\n", optarg);
+                return 2;
+            }
+            families.emplace_back(family);
+            break;
+        default:
+            return 2;
+        }
+    }
+    if (ccrs.empty()) {
+        ccrs = {0.1, 1.0, 10.0};
+    }
+    std::vector<std::string> stgPaths(argv + optind, argv + argc);
+    if (families.empty() && stgPaths.empty()) {
+        families = {GraphFamily::Layered, GraphFamily::ForkJoin, GraphFamily::GaussianElimination, GraphFamily::Fft,
+                    GraphFamily::Montage, GraphFamily::Chain};
+    }
+
+    QualitySummary summary;
+    std::printf("%d machines\n%-12s %6s %6s %-10s %10s %8s %10s %8s %8s\n", numMachines, "workflow", "jobs", "ccr",
+                "algorithm", "makespan", "speedup", "efficiency", "SLR", "bound");
+    for (double ccr: ccrs) {
+        options.ccr = ccr;
+        for (GraphFamily family: families) {
+            CSRWorkflowGraph graph = generateWorkflow(family, options).freeze();
+            compareAlgorithms(GRAPH_FAMILY_NAMES[static_cast<int>(family)], ccr, graph, numMachines, summary);
+        }
+        for (const std::string& path: stgPaths) {
+            SyntheticWorkflow workflow;
+            if (!readStgFile(path, options, workflow)) {
+                std::fprintf(stderr, "quality_bench: cannot read STG file '%s'\n", path.c_str());
+                return 1;
+            }
+            std::string label = path.substr(path.find_last_of('/') == std::string::npos ? 0 : path.find_last_of('/') + 1);
+            compareAlgorithms(label, ccr, workflow.freeze(), numMachines, summary);
+        }
+    }
+
+    std::printf("\n%-10s %8s %8s %8s\n", "algorithm", "mean SLR", "best", "invalid");
+    for (size_t a = 0; a < NUM_ALGORITHMS; a++) {
+        std::printf("%-10s %8.3f %5d/%-3d %7d\n", ALGORITHMS[a].name, summary.slrSum[a] / std::max(1, summary.numWorkflows),
+                    summary.numBest[a], summary.numWorkflows, summary.numInvalid[a]);
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+Compares the ready queue implementations of WorkflowSchedule::topologicalSort()
+on random layered DAGs. Critical weights are computed once per graph and excluded
+from the timings, so only Kahn's loop and its ready queue are measured. The last
+column is the deterministic parallel sort on all hardware threads.
+
+Usage: ready_queue_bench [number of jobs ...]   (default: 10000 1000000 10000000)
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "all.h"
+
+/**
+ * Builds a random layered DAG with about sqrt(numJobs) jobs per layer,
+ * where every job outside the first layer depends on two jobs of the previous layer.
+ * @param numJobs Number of jobs
+ * @return Frozen graph
+ */
+static CSRWorkflowGraph buildLayeredGraph(size_t numJobs) {
+    std::mt19937 rng(1);
+    size_t width = std::max<size_t>(1, std::sqrt(static_cast<double>(numJobs)));
+    std::vector<int> executionTimes(numJobs);
+    std::vector<JobId> fromJobs, toJobs;
+    std::vector<int> commTimes;
+    for (size_t job = 0; job < numJobs; job++) {
+        executionTimes[job] = 1 + rng() % 100;
+        if (job < width) {
+            continue;
+        }
+        size_t layerStart = job / width * width;
+        for (int d = 0; d < 2; d++) {
+            fromJobs.emplace_back(layerStart - width + rng() % width);
+            toJobs.emplace_back(job);
+            commTimes.emplace_back(rng() % 100);
+        }
+    }
+    return CSRWorkflowGraph(numJobs, executionTimes.data(), commTimes.size(), fromJobs.data(), toJobs.data(), commTimes.data());
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.emplace_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {10000, 1000000, 10000000};
+    }
+
+    const ReadyQueueType types[] = {ReadyQueueType::BinaryHeap, ReadyQueueType::DaryHeap, ReadyQueueType::RadixHeap};
+    const char* typeNames[] = {"binary", "4-ary", "radix"};
+
+    ThreadPool pool;
+    std::printf("%12s %12s %12s %12s %12s\n", "jobs", typeNames[0], typeNames[1], typeNames[2], "parallel");
+    for (size_t numJobs: sizes) {
+        CSRWorkflowGraph graph = buildLayeredGraph(numJobs);
+        std::vector<int> criticalWeights = computeCriticalWeights(graph);
+        WorkflowSchedule schedule(&graph, 1);
+
+        std::printf("%12zu", numJobs);
+        for (int t = 0; t < 4; t++) {
+            if (t < 3) {
+                schedule.setReadyQueue(types[t]);
+            } else {
+                schedule.setThreadPool(&pool);
+                schedule.setParallelTopologicalSort(true);
+            }
+            // best of three runs
+            double best = 1e30;
+            for (int run = 0; run < 3; run++) {
+                auto start = std::chrono::steady_clock::now();
+                std::vector<JobId> order = schedule.topologicalSort(criticalWeights);
+                best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+            std::printf(" %10.4fs", best);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*
+Measures the throughput of the scheduling phases on synthetic workflows of every
+DAG family: the critical weight computation, the topological sort given the
+critical weights, and the whole schedule() from scratch. Every timing is the best
+of a few runs, and throughputs are in millions of jobs per second.
+
+Usage: workflow_bench [-g family] [-d degree] [-c ccr] [-k machines] [-r runs] [number of jobs ...]
+  family: layered, forkjoin, gauss, fft, montage or chain (default: all of them)
+  degree: average predecessors per job of the layered family (default: 2)
+  ccr:    communication-to-computation ratio (default: 1)
+  defaults: 8 machines, 3 runs, 100000 and 1000000 jobs
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <string>
+#include <vector>
+#include "generators.h"
+
+/**
+ * Runs a function several times.
+ * @param numRuns Number of runs
+ * @param function The function
+ * @return Shortest duration of a run in seconds
+ */
+template <class Function>
+static double timeBest(int numRuns, Function function) {
+    double best = 1e30;
+    for (int run = 0; run < numRuns; run++) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    GeneratorOptions options;
+    std::vector<GraphFamily> families;
+    int numMachines = 8, numRuns = 3, opt;
+    while ((opt = getopt(argc, argv, "g:d:c:k:r:")) != -1) {
+        GraphFamily family;
+        switch (opt) {
+        case 'g':
+            if (!parseGraphFamily(optarg, family)) {
+                std::fprintf(stderr, "workflow_bench: unknown family '%s'\n", optarg);
+                return 2;
+            }
+            families.emplace_back(family);
+            break;
+        case 'd':
+            options.degree = std::strtod(optarg, nullptr);
+            break;
+        case 'c':
+            options.ccr = std::strtod(optarg, nullptr);
+            break;
+        case 'k':
+            numMachines = std::max(1, std::atoi(optarg));
+            break;
+        case 'r':
+            numRuns = std::max(1, std::atoi(optarg));
+            break;
+        default:
+            return 2;
+        }
+    }
+    std::vector<size_t> sizes;
+    for (int i = optind; i < argc; i++) {
+        sizes.emplace_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {100000, 1000000};
+    }
+    if (families.empty()) {
+        families = {GraphFamily::Layered, GraphFamily::ForkJoin, GraphFamily::GaussianElimination, GraphFamily::Fft,
+                    GraphFamily::Montage, GraphFamily::Chain};
+    }
+
+    std::printf("%-9s %10s %10s %10s %8s %10s %8s %10s %8s %12s\n", "family", "jobs", "comms",
+                "rank", "Mjobs/s", "sort", "Mjobs/s", "schedule", "Mjobs/s", "makespan");
+    for (GraphFamily family: families) {
+        for (size_t numJobs: sizes) {
+            options.numJobs = numJobs;
+            CSRWorkflowGraph graph = generateWorkflow(family, options).freeze();
+            WorkflowSchedule schedule(&graph, numMachines);
+            double jobs = graph.getNumJobs() / 1e6;
+
+            std::vector<int> criticalWeights;
+            double rankTime = timeBest(numRuns, [&]() { criticalWeights = schedule.getCriticalWeights(); });
+            double sortTime = timeBest(numRuns, [&]() { schedule.topologicalSort(criticalWeights); });
+            int makespan = 0;
+            double scheduleTime = timeBest(numRuns, [&]() { makespan = schedule.schedule().first; });
+
+            std::printf("%-9s %10zu %10zu %9.4fs %8.2f %9.4fs %8.2f %9.4fs %8.2f %12d\n",
+                        GRAPH_FAMILY_NAMES[static_cast<int>(family)], graph.getNumJobs(), graph.getNumCommunications(),
+                        rankTime, jobs / rankTime, sortTime, jobs / sortTime, scheduleTime, jobs / scheduleTime, makespan);
+        }
+    }
+    return 0;
+}
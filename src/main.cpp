@@ -24,20 +24,185 @@ and algorithm description, I will evaluate
 3) your code readability (such as code format and necessary comments), algorithm efficiency, and self-learning capacity.
 */
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <getopt.h>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 #include "workflow/all.h"
 
+static const char* USAGE =
+    "Usage: main [options] [workflow file]\n"
+    "Schedules a workflow read from a file, or the built-in example workflow if none is given.\n"
+    "\n"
+    "  -f, --format FORMAT      Input format: edgelist, dot, dax, wfcommons or binary\n"
+    "                           (default: from the extension, .wfg being binary)\n"
+    "  -s, --time-scale FACTOR  Factor turning the times of the file into integer times (default: 1)\n"
+    "  -b, --bandwidth BYTES    Bytes transferred per time unit, for DAX and WfCommons file sizes (default: 0, ignored)\n"
+    "  -k, --machines K         Number of machines (default: 2)\n"
+    "  -r, --ordering POLICY    Ordering policy: static, dls or etf (default: static)\n"
+    "  -p, --placement POLICY   Placement policy: append or insertion (default: append)\n"
+    "  -q, --queue TYPE         Ready queue of the static order: binary, dary or radix (default: binary)\n"
+    "  -t, --threads N          Threads for critical weights and sorting, 0 for all hardware threads (default: 1)\n"
+    "  -w, --output-format FMT  Output format: text, csv, json, trace or binary (default: text)\n"
+    "  -o, --output PATH        Output file, - for the standard output (default: -)\n"
+    "  -T, --timing             Report the time of every phase on the standard error\n"
+    "  -S, --stats FORMAT       Dump the scheduling counters on the standard error as json or prometheus\n"
+    "                           (needs a build with make STATS=1)\n"
+    "  -h, --help               Show this help\n";
+
+// Settings given on the command line.
+struct CommandLineOptions {
+    std::string inputPath;          ///< Workflow file, empty for the built-in example
+    std::string inputFormat;        ///< Name of the input format, empty to guess it from the extension
+    WorkflowReadOptions readOptions;    ///< Options of the text formats
+    int numMachines = 2;            ///< Number of machines available for scheduling
+    OrderingPolicy orderingPolicy = OrderingPolicy::StaticCriticalPath;    ///< Order in which jobs are placed
+    PlacementPolicy placementPolicy = PlacementPolicy::Append;  ///< How the start time of a job is chosen
+    ReadyQueueType readyQueueType = ReadyQueueType::BinaryHeap; ///< Ready queue of the topological sort
+    int numThreads = 1;             ///< Threads for the parallel phases, 0 for hardware concurrency
+    ScheduleFormat outputFormat = ScheduleFormat::Text;     ///< Format the schedule is written in
+    std::string outputPath = "-";   ///< Destination of the schedule, - for the standard output
+    bool showTiming = false;        ///< Whether the time of every phase is reported
+    std::string statsFormat;        ///< Format of the scheduling counters dumped, empty for none
+};
+
 /**
- * Main function for executing the workflow scheduling example.
- * Creates a WorkflowGraph, adds jobs and communications, prints the workflow,
- * and then schedules the workflow using WorkflowSchedule and prints the result.
- * @return 0 on successful execution
+ * Looks up the value of an option among its allowed names.
+ * @param value Value given on the command line
+ * @param names Allowed names, in the order of the values they stand for
+ * @param index Set to the position of the value among the names if it is one
+ * @return True if the value is one of the names, false otherwise
  */
-int main() {
-    // Create a WorkflowGraph object
-    WorkflowGraph graph;
+template <size_t N>
+static bool parseChoice(const char* value, const char* const (&names)[N], int& index) {
+    for (size_t i = 0; i < N; i++) {
+        if (value == std::string(names[i])) {
+            index = static_cast<int>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Parses the command line.
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @param options Receives the settings
+ * @param status Set to the exit status of the program if it must stop
+ * @return True to go on scheduling, false to stop
+ */
+static bool parseCommandLine(int argc, char** argv, CommandLineOptions& options, int& status) {
+    static const char* const orderingNames[] = {"static", "dls", "etf"};
+    static const char* const placementNames[] = {"append", "insertion"};
+    static const char* const queueNames[] = {"binary", "dary", "radix"};
+    static const char* const outputNames[] = {"text", "csv", "json", "trace", "binary"};
+    static const struct option longOptions[] = {
+        {"format", required_argument, nullptr, 'f'},
+        {"time-scale", required_argument, nullptr, 's'},
+        {"bandwidth", required_argument, nullptr, 'b'},
+        {"machines", required_argument, nullptr, 'k'},
+        {"ordering", required_argument, nullptr, 'r'},
+        {"placement", required_argument, nullptr, 'p'},
+        {"queue", required_argument, nullptr, 'q'},
+        {"threads", required_argument, nullptr, 't'},
+        {"output-format", required_argument, nullptr, 'w'},
+        {"output", required_argument, nullptr, 'o'},
+        {"timing", no_argument, nullptr, 'T'},
+        {"stats", required_argument, nullptr, 'S'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt, choice;
+    char* last;
+    while ((opt = getopt_long(argc, argv, "f:s:b:k:r:p:q:t:w:o:TS:h", longOptions, nullptr)) != -1) {
+        bool isValid = true;
+        switch (opt) {
+        case 'f':
+            options.inputFormat = optarg;
+            break;
+        case 's':
+            options.readOptions.timeScale = std::strtod(optarg, &last);
+            isValid = *last == '\0' && options.readOptions.timeScale > 0;
+            break;
+        case 'b':
+            options.readOptions.bandwidth = std::strtod(optarg, &last);
+            isValid = *last == '\0' && options.readOptions.bandwidth >= 0;
+            break;
+        case 'k':
+            options.numMachines = static_cast<int>(std::strtol(optarg, &last, 10));
+            isValid = *last == '\0' && options.numMachines > 0;
+            break;
+        case 'r':
+            isValid = parseChoice(optarg, orderingNames, choice);
+            options.orderingPolicy = static_cast<OrderingPolicy>(choice);
+            break;
+        case 'p':
+            isValid = parseChoice(optarg, placementNames, choice);
+            options.placementPolicy = static_cast<PlacementPolicy>(choice);
+            break;
+        case 'q':
+            isValid = parseChoice(optarg, queueNames, choice);
+            options.readyQueueType = static_cast<ReadyQueueType>(choice);
+            break;
+        case 't':
+            options.numThreads = static_cast<int>(std::strtol(optarg, &last, 10));
+            isValid = *last == '\0' && options.numThreads >= 0;
+            break;
+        case 'w':
+            isValid = parseChoice(optarg, outputNames, choice);
+            options.outputFormat = static_cast<ScheduleFormat>(choice);
+            break;
+        case 'o':
+            options.outputPath = optarg;
+            break;
+        case 'T':
+            options.showTiming = true;
+            break;
+        case 'S':
+            options.statsFormat = optarg;
+            isValid = options.statsFormat == "json" || options.statsFormat == "prometheus";
+            break;
+        case 'h':
+            std::fputs(USAGE, stdout);
+            status = EXIT_SUCCESS;
+            return false;
+        default:
+            std::fputs(USAGE, stderr);
+            status = 2;
+            return false;
+        }
+        if (!isValid) {
+            std::fprintf(stderr, "main: invalid value '%s' for option -%c\n%s", optarg, opt, USAGE);
+            status = 2;
+            return false;
+        }
+    }
+
+    if (optind < argc) {
+        options.inputPath = argv[optind++];
+    }
+    if (optind < argc) {
+        std::fprintf(stderr, "main: unexpected argument '%s'\n%s", argv[optind], USAGE);
+        status = 2;
+        return false;
+    }
+    return true;
+}
 
-    // Add jobs and communications to the workflow graph
+/**
+ * Adds the jobs and communications of the example workflow.
+ * @param graph Empty workflow graph
+ */
+static void buildExampleWorkflow(WorkflowGraph& graph) {
     graph.addJob("A", 5);
     graph.addJob("B", 4);
     graph.addJob("C", 4);
@@ -61,24 +226,149 @@ int main() {
     graph.addCommunication("H", "I", 5);
     graph.addCommunication("I", "C", 7);
     graph.addCommunication("I", "F", 1);
+}
+
+/**
+ * Loads the workflow, schedules it and writes the schedule, timing every phase.
+ * @param options Settings given on the command line
+ */
+static void run(const CommandLineOptions& options) {
+    typedef std::chrono::steady_clock Clock;
+    std::vector<std::pair<const char*, double>> phases;  // Name and duration in milliseconds of every phase
+    Clock::time_point phaseStart = Clock::now();
+    auto endPhase = [&](const char* name) {
+        Clock::time_point now = Clock::now();
+        phases.emplace_back(name, std::chrono::duration<double, std::milli>(now - phaseStart).count());
+        phaseStart = now;
+    };
+
+    // Load: the frozen graph is scheduled, either built from a text file or mapped in place from a binary file
+    WorkflowGraph graph;
+    std::unique_ptr<MappedWorkflow> mappedWorkflow;
+    const CSRWorkflowGraph* frozenGraph;
+    JobNameFunction jobNames;
+    std::string format = options.inputFormat;
+    if (format.empty() && options.inputPath.size() >= 4 &&
+        options.inputPath.compare(options.inputPath.size() - 4, 4, ".wfg") == 0) {
+        format = "binary";
+    }
+    if (options.inputPath.empty()) {
+        buildExampleWorkflow(graph);
+        if (options.outputFormat == ScheduleFormat::Text && options.outputPath == "-") {
+            std::cout << "Workflow Graph:\n";
+            graph.printWorkflow();
+        }
+        frozenGraph = &graph.freeze();
+        jobNames = [&](JobId jobId) { return graph.getJobName(jobId); };
+    } else if (format == "binary") {
+        mappedWorkflow.reset(new MappedWorkflow(options.inputPath));
+        frozenGraph = &mappedWorkflow->getGraph();
+        jobNames = [&](JobId jobId) { return mappedWorkflow->getJobName(jobId); };
+    } else {
+        static const char* const formatNames[] = {"edgelist", "dot", "dax", "wfcommons"};
+        int choice = static_cast<int>(guessWorkflowFormat(options.inputPath));
+        if (!format.empty() && !parseChoice(format.c_str(), formatNames, choice)) {
+            throw std::runtime_error("Unknown workflow format: " + format);
+        }
+        readWorkflow(options.inputPath, static_cast<WorkflowFormat>(choice), graph, options.readOptions);
+        frozenGraph = &graph.freeze();
+        jobNames = [&](JobId jobId) { return graph.getJobName(jobId); };
+    }
+
+    WorkflowSchedule schedule(frozenGraph, options.numMachines);
+    schedule.setOrderingPolicy(options.orderingPolicy);
+    schedule.setPlacementPolicy(options.placementPolicy);
+    schedule.setReadyQueue(options.readyQueueType);
+    std::unique_ptr<ThreadPool> threadPool;
+    if (options.numThreads != 1) {
+        threadPool.reset(new ThreadPool(options.numThreads));
+        schedule.setThreadPool(threadPool.get());
+        schedule.setParallelTopologicalSort(true);
+    }
+    endPhase("load");
+
+    // Rank: critical weight of every job
+    std::vector<int> criticalWeights = schedule.getCriticalWeights();
+    endPhase("rank");
 
-    // Print the workflow
-    std::cout << "Workflow Graph:\n";
-    graph.printWorkflow();
+    // Sort: dynamic ordering policies choose the next job while placing, so they only check for cycles here, before the
+    // first job placed is written out
+    size_t numJobs = frozenGraph->getNumJobs();
+    std::vector<JobId> topOrder;
+    if (options.orderingPolicy == OrderingPolicy::StaticCriticalPath) {
+        topOrder = schedule.topologicalSort(criticalWeights);
+        if (topOrder.size() != numJobs) {
+            throw std::runtime_error("workflow has a cycle");
+        }
+    } else if (!isAcyclic(*frozenGraph)) {
+        throw std::runtime_error("workflow has a cycle");
+    }
+    endPhase("sort");
 
-    // Create a WorkflowSchedule object with 2 machines
-    WorkflowSchedule schedule(&graph, 2);
+    // Place and write: jobs stream into the writer as they are placed, unless the write is timed as a phase of its own
+    BufferedOutput out(options.outputPath);
+    std::unique_ptr<ScheduleWriter> writer = makeScheduleWriter(options.outputFormat, out, jobNames);
+    ScheduleOrder scheduleOrder;
+    if (options.showTiming) {
+        scheduleOrder.reserve(numJobs);
+    }
+    auto emit = [&](const ScheduledJob& scheduledJob) {
+        if (options.showTiming) {
+            scheduleOrder.emplace_back(scheduledJob);
+        } else {
+            writer->write(scheduledJob);
+        }
+    };
+    int makespan = options.orderingPolicy == OrderingPolicy::StaticCriticalPath ? schedule.placeInOrder(topOrder, emit)
+                                                                                : schedule.placeByPriority(criticalWeights, emit);
+    if (options.showTiming) {
+        endPhase("place");
+        for (const ScheduledJob& scheduledJob: scheduleOrder) {
+            writer->write(scheduledJob);
+        }
+    }
+    writer->finish(makespan);
+    endPhase(options.showTiming ? "write" : "place+write");
 
-    // Schedule the workflow and get the result
-    auto res = schedule.schedule();
+    if (options.showTiming) {
+        double total = 0;
+        std::fprintf(stderr, "jobs: %zu, communications: %zu, machines: %d, makespan: %d\n", frozenGraph->getNumJobs(),
+                     frozenGraph->getNumCommunications(), options.numMachines, makespan);
+        for (const auto& phase: phases) {
+            std::fprintf(stderr, "%-6s %12.3f ms\n", phase.first, phase.second);
+            total += phase.second;
+        }
+        std::fprintf(stderr, "%-6s %12.3f ms\n", "total", total);
+    }
+    if (!options.statsFormat.empty()) {
+        if (!ScheduleStats::isEnabled) {
+            std::fputs("main: scheduling counters need a build with make STATS=1\n", stderr);
+        }
+        const ScheduleStats& stats = getScheduleStats();
+        std::fputs(options.statsFormat == "json" ? (stats.toJson() + "\n").c_str() : stats.toPrometheus().c_str(), stderr);
+    }
+}
 
-    // Print the scheduled order of jobs and the minimum time
-    std::cout << "Scheduled Order:\n";
-    for (const auto& scheduledJob: res.second) {
-        std::cout << " Schedule Job \"" << scheduledJob.job->name << "\" at machine " << scheduledJob.machineId << " at time " << scheduledJob.scheduleTime << " where execution starts at " << scheduledJob.startTime << " and finishes at " << scheduledJob.finishTime;
-        std::cout << std::endl;
+/**
+ * Main function of the workflow scheduler.
+ * Reads a workflow from the file given on the command line, or builds the example workflow and prints it if there is
+ * none, schedules it with the selected policies and writes the schedule in the selected format.
+ * @param argc Number of arguments
+ * @param argv Arguments, see USAGE
+ * @return 0 on successful execution, 1 if the workflow can't be read or the schedule written, 2 on invalid arguments
+ */
+int main(int argc, char** argv) {
+    CommandLineOptions options;
+    int status;
+    if (!parseCommandLine(argc, argv, options, status)) {
+        return status;
     }
-    std::cout << "\nMinimum time to complete workflow: " << res.first << std::endl;
 
-    return 0;
+    try {
+        run(options);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "main: %s\n", e.what());
+        return 1;
+    }
+    return EXIT_SUCCESS;
 }
@@ -1 +1,5 @@
-#include "schedule.h"
\ No newline at end of file
+#include "schedule.h"
+#include "online.h"
+#include "mapped.h"
+#include "formats.h"
+#include "output.h"
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Bump allocator owning fixed-size memory blocks.
+ * Objects are carved out of the current block by advancing a pointer and are never freed individually;
+ * all blocks are released at once when the arena is destroyed.
+ */
+class Arena {
+private:
+    std::vector<char*> blocks;  ///< Memory blocks owned by the arena
+    char* current;              ///< Next free byte in the current block
+    char* end;                  ///< End of the current block
+    size_t blockSize;           ///< Size of regular blocks in bytes
+    size_t bytesReserved;       ///< Total size of all blocks in bytes
+
+    /**
+     * Allocates a new block and records it for release.
+     * @param size Size of the block in bytes
+     * @return Pointer to the start of the block
+     */
+    char* allocateBlock(size_t size) {
+        char* block = static_cast<char*>(std::malloc(size));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        blocks.emplace_back(block);
+        bytesReserved += size;
+        return block;
+    }
+public:
+    /**
+     * Constructor for Arena.
+     * @param _blockSize Size of regular blocks in bytes
+     */
+    explicit Arena(size_t _blockSize = 64 * 1024): current(nullptr), end(nullptr), blockSize(_blockSize), bytesReserved(0) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Destructor for Arena.
+     * Releases all blocks at once.
+     */
+    ~Arena() {
+        release();
+    }
+
+    /**
+     * Allocates uninitialized memory from the arena.
+     * Requests larger than a quarter of the block size get a dedicated block so that they don't waste the current one.
+     * @param size Number of bytes to allocate
+     * @param alignment Required alignment, a power of two not exceeding alignof(std::max_align_t)
+     * @return Pointer to the allocated memory
+     */
+    void* allocate(size_t size, size_t alignment) {
+        size_t padding = (alignment - reinterpret_cast<size_t>(current) % alignment) % alignment;
+        if (current != nullptr && padding + size <= static_cast<size_t>(end - current)) {
+            void* memory = current + padding;
+            current += padding + size;
+            return memory;
+        }
+
+        if (size > blockSize / 4) {
+            return allocateBlock(size);
+        }
+
+        current = allocateBlock(blockSize);
+        end = current + blockSize;
+        void* memory = current;
+        current += size;
+        return memory;
+    }
+
+    /**
+     * Makes sure that the next allocations totalling up to the given size are served from a single block.
+     * @param bytes Number of bytes to set aside
+     */
+    void reserve(size_t bytes) {
+        if (current != nullptr && bytes <= static_cast<size_t>(end - current)) {
+            return;
+        }
+
+        size_t size = std::max(bytes, blockSize);
+        current = allocateBlock(size);
+        end = current + size;
+    }
+
+    /**
+     * Constructs an object in the arena.
+     * Destructors are never run, so only trivially destructible types are allowed.
+     * @param args Arguments forwarded to the constructor of T
+     * @return Pointer to the constructed object
+     */
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed individually");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Releases all blocks, invalidating every object allocated from the arena.
+     */
+    void release() {
+        for (char* block: blocks) {
+            std::free(block);
+        }
+        blocks.clear();
+        current = end = nullptr;
+        bytesReserved = 0;
+    }
+
+    /**
+     * @return Total number of bytes held by the arena
+     */
+    size_t getBytesReserved() const {
+        return bytesReserved;
+    }
+};
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "dynamic.h"
+#include "graph.h"
+#include "hash.h"
+#include "placement.h"
+
+// Identifies a schedule by the content of the workflow and the settings of the scheduler that change its result.
+struct ScheduleCacheKey {
+    GraphHash graphHash;                ///< Content hash of the workflow
+    int numMachines;                    ///< Number of machines available for scheduling
+    PlacementPolicy placementPolicy;    ///< How the start time of a job on a machine is chosen
+    OrderingPolicy orderingPolicy;      ///< Order in which jobs are placed
+
+    bool operator==(const ScheduleCacheKey& other) const {
+        return graphHash == other.graphHash && numMachines == other.numMachines &&
+               placementPolicy == other.placementPolicy && orderingPolicy == other.orderingPolicy;
+    }
+
+    /**
+     * @return Name of the file holding the schedule in an on-disk cache
+     */
+    std::string getFileName() const {
+        char name[96];
+        std::snprintf(name, sizeof(name), "%016llx%016llx-k%d-p%d-o%d.sched",
+                      static_cast<unsigned long long>(graphHash.high), static_cast<unsigned long long>(graphHash.low),
+                      numMachines, static_cast<int>(placementPolicy), static_cast<int>(orderingPolicy));
+        return name;
+    }
+};
+
+// Hashes a cache key for the in-memory index.
+struct ScheduleCacheKeyHash {
+    size_t operator()(const ScheduleCacheKey& key) const {
+        uint64_t settings = (static_cast<uint64_t>(key.numMachines) << 8) |
+                            (static_cast<uint64_t>(key.placementPolicy) << 4) | static_cast<uint64_t>(key.orderingPolicy);
+        return static_cast<size_t>(key.graphHash.low ^ GraphHash::mix(key.graphHash.high ^ settings));
+    }
+};
+
+/**
+ * Least recently used cache of schedules keyed by the content hash of the workflow, optionally backed by a directory
+ * of schedule files that outlive the process.
+ * Jobs of a cached schedule are kept by name, so that the schedule also applies to a workflow with the same content
+ * whose jobs were added in another order. Such a workflow gets a valid schedule of the same content, which may differ
+ * from the one computed for it where equally critical jobs are ordered by id.
+ * The cache is not thread-safe.
+ */
+class ScheduleCache {
+private:
+    // A cached schedule
+    struct Entry {
+        ScheduleCacheKey key;               ///< What the schedule was computed for
+        int makespan;                       ///< Makespan of the schedule
+        std::vector<std::string> jobNames;  ///< Name of every scheduled job, in schedule order
+        ScheduleOrder scheduleOrder;        ///< Scheduled jobs, with the ids of the workflow they were computed for
+    };
+
+    enum : uint32_t { FILE_MAGIC = 0x31435357u };  ///< "WSC1" in little endian, first word of a schedule file
+
+    size_t capacity;            ///< Maximum number of schedules kept in memory
+    std::string directory;      ///< Directory of the on-disk cache, empty for none
+    std::list<Entry> entries;   ///< Cached schedules, most recently used first
+    std::unordered_map<ScheduleCacheKey, std::list<Entry>::iterator, ScheduleCacheKeyHash> index;  ///< Entry of every key
+    size_t numHits = 0;         ///< Number of lookups that found a schedule
+    size_t numMisses = 0;       ///< Number of lookups that found none
+
+    /**
+     * @param key Key of the schedule
+     * @return Path of the file holding the schedule in the on-disk cache
+     */
+    std::string getPath(const ScheduleCacheKey& key) const {
+        return directory + "/" + key.getFileName();
+    }
+
+    /**
+     * Writes a schedule to the on-disk cache, through a temporary file renamed at the end so that readers never see
+     * a partial file. The file holds the magic word, the makespan and the number of jobs, followed by the name length,
+     * name, machine, schedule time, start time and finish time of every job, in native byte order.
+     * Failures are ignored, since the schedule stays cached in memory.
+     * @param entry The schedule
+     */
+    void store(const Entry& entry) const {
+        std::string path = getPath(entry.key), tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+            uint32_t header[] = {FILE_MAGIC, static_cast<uint32_t>(entry.makespan), static_cast<uint32_t>(entry.jobNames.size())};
+            out.write(reinterpret_cast<const char*>(header), sizeof(header));
+            for (size_t i = 0; i < entry.jobNames.size(); i++) {
+                const ScheduledJob& job = entry.scheduleOrder[i];
+                uint32_t length = entry.jobNames[i].size();
+                int32_t times[] = {job.machineId, job.scheduleTime, job.startTime, job.finishTime};
+                out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                out.write(entry.jobNames[i].data(), length);
+                out.write(reinterpret_cast<const char*>(times), sizeof(times));
+            }
+            if (!out) {
+                out.close();
+                std::remove(tempPath.c_str());
+                return;
+            }
+        }
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+        }
+    }
+
+    /**
+     * Reads a schedule from the on-disk cache.
+     * @param key Key of the schedule
+     * @param numJobs Number of jobs of the workflow being scheduled
+     * @param entry Receives the schedule, whose jobs have no ids
+     * @return True if the schedule was found and read, false if it is missing, doesn't have numJobs jobs or the file
+     * is corrupt
+     */
+    bool load(const ScheduleCacheKey& key, size_t numJobs, Entry& entry) const {
+        std::ifstream in(getPath(key).c_str(), std::ios::binary | std::ios::ate);
+        std::streamoff fileSize = in.tellg();
+        in.seekg(0);
+        uint32_t header[3];
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != FILE_MAGIC || header[2] != numJobs) {
+            return false;
+        }
+
+        entry.key = key;
+        entry.makespan = static_cast<int>(header[1]);
+        entry.jobNames.resize(header[2]);
+        entry.scheduleOrder.clear();
+        entry.scheduleOrder.reserve(header[2]);
+        for (size_t i = 0; i < entry.jobNames.size(); i++) {
+            uint32_t length;
+            int32_t times[4];
+            if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)) || length > fileSize - in.tellg()) {
+                return false;
+            }
+            entry.jobNames[i].resize(length);
+            if (!in.read(&entry.jobNames[i][0], length) || !in.read(reinterpret_cast<char*>(times), sizeof(times))) {
+                return false;
+            }
+            entry.scheduleOrder.emplace_back(0, times[0], times[1], times[2], times[3]);
+        }
+        return in.peek() == std::ifstream::traits_type::eof();
+    }
+
+    /**
+     * Forgets a schedule cached in memory.
+     * @param position Entry of the schedule in the index
+     */
+    void evict(std::unordered_map<ScheduleCacheKey, std::list<Entry>::iterator, ScheduleCacheKeyHash>::iterator position) {
+        entries.erase(position->second);
+        index.erase(position);
+    }
+
+    /**
+     * Caches a schedule in memory as the most recently used one, evicting the least recently used one if full.
+     * @param entry The schedule
+     */
+    void insertEntry(Entry&& entry) {
+        auto found = index.find(entry.key);
+        if (found != index.end()) {
+            evict(found);
+        }
+        entries.push_front(std::move(entry));
+        index[entries.front().key] = entries.begin();
+        if (entries.size() > capacity) {
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+public:
+    /**
+     * Constructor for ScheduleCache.
+     * @param _capacity Maximum number of schedules kept in memory, at least one
+     * @param _directory Existing directory of the on-disk cache, or empty to keep schedules in memory only
+     */
+    explicit ScheduleCache(size_t _capacity = 64, const std::string& _directory = ""):
+        capacity(std::max<size_t>(1, _capacity)), directory(_directory) {}
+
+    /**
+     * Looks up the schedule of a workflow, in memory first and then on disk.
+     * @param key Key of the schedule
+     * @param graph Workflow being scheduled, whose content hash is part of the key
+     * @param result Receives the makespan and the scheduled jobs with the ids of the workflow
+     * @return True if the schedule was found, false otherwise
+     */
+    bool find(const ScheduleCacheKey& key, const WorkflowGraph& graph, std::pair<int, ScheduleOrder>& result) {
+        auto found = index.find(key);
+        if (found == index.end()) {
+            Entry entry;
+            if (directory.empty() || !load(key, graph.getNumJobs(), entry)) {
+                numMisses++;
+                return false;
+            }
+            insertEntry(std::move(entry));
+            found = index.find(key);
+        } else {
+            entries.splice(entries.begin(), entries, found->second);
+        }
+
+        // translate names into the ids of the workflow, another number of jobs or a name it lacks meaning the hash
+        // collided, so the entry is evicted to be replaced by the schedule computed instead
+        const Entry& entry = *found->second;
+        result.first = entry.makespan;
+        result.second = entry.scheduleOrder;
+        bool isTranslated = entry.jobNames.size() == graph.getNumJobs();
+        for (size_t i = 0; isTranslated && i < entry.jobNames.size(); i++) {
+            isTranslated = graph.findJobId(entry.jobNames[i], result.second[i].jobId);
+        }
+        if (!isTranslated) {
+            evict(found);
+            numMisses++;
+            return false;
+        }
+        numHits++;
+        return true;
+    }
+
+    /**
+     * Caches the schedule of a workflow, in memory and on disk if there is a directory.
+     * @param key Key of the schedule
+     * @param graph Workflow the schedule was computed for
+     * @param result Makespan and scheduled jobs
+     */
+    void insert(const ScheduleCacheKey& key, const WorkflowGraph& graph, const std::pair<int, ScheduleOrder>& result) {
+        Entry entry;
+        entry.key = key;
+        entry.makespan = result.first;
+        entry.scheduleOrder = result.second;
+        entry.jobNames.reserve(result.second.size());
+        for (const ScheduledJob& job: result.second) {
+            entry.jobNames.emplace_back(graph.getJobName(job.jobId));
+        }
+        if (!directory.empty()) {
+            store(entry);
+        }
+        insertEntry(std::move(entry));
+    }
+
+    /**
+     * Forgets all schedules cached in memory, keeping the on-disk cache.
+     */
+    void clear() {
+        entries.clear();
+        index.clear();
+    }
+
+    /**
+     * @return Number of schedules cached in memory
+     */
+    size_t size() const {
+        return entries.size();
+    }
+
+    /**
+     * @return Number of lookups that found a schedule
+     */
+    size_t getNumHits() const {
+        return numHits;
+    }
+
+    /**
+     * @return Number of lookups that found no schedule
+     */
+    size_t getNumMisses() const {
+        return numMisses;
+    }
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "csr.h"
+#include "thread_pool.h"
+
+/**
+ * Calculates the critical weight of every job, i.e. the maximum sum of job execution and communication time
+ * among all the paths from the job to a terminal job.
+ * Jobs are swept in reverse topological order, starting from the terminal jobs and releasing a job once all
+ * of its successors are done, so the depth of the graph doesn't matter and every job and communication is
+ * visited exactly once.
+ * @param graph Frozen workflow graph, must be acyclic
+ * @return Vector of critical weights indexed by job id
+ */
+inline std::vector<int> computeCriticalWeights(const CSRWorkflowGraph& graph) {
+    size_t numJobs = graph.getNumJobs();
+    std::vector<int> criticalWeights(numJobs, 0);
+
+    // number of successors of each job whose critical weight is still unknown
+    std::vector<int> pendingSuccessors(numJobs);
+    // jobs in reverse topological order, doubling as the FIFO queue of jobs ready to be evaluated
+    std::vector<JobId> reverseOrder;
+    reverseOrder.reserve(numJobs);
+    for (JobId job = 0; job < numJobs; job++) {
+        pendingSuccessors[job] = graph.getOutdegree(job);
+        if (pendingSuccessors[job] == 0) {
+            reverseOrder.emplace_back(job);
+        }
+    }
+
+    for (size_t head = 0; head < reverseOrder.size(); head++) {
+        JobId job = reverseOrder[head];
+        int jobCriticalWeight = 0;
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            jobCriticalWeight = std::max(jobCriticalWeight, comm.commTime + criticalWeights[comm.job]);
+        }
+        criticalWeights[job] = jobCriticalWeight + graph.getExecutionTime(job);
+
+        for (const CSREdge& comm: graph.getInEdges(job)) {
+            if (--pendingSuccessors[comm.job] == 0) {
+                reverseOrder.emplace_back(comm.job);
+            }
+        }
+    }
+
+    return criticalWeights;
+}
+
+/**
+ * Parallel version of computeCriticalWeights() giving the same critical weights.
+ * The graph is peeled level by level in reverse topological order: all jobs of a level have every successor
+ * evaluated already, so they are evaluated concurrently, and each one atomically decrements the pending successor
+ * count of its predecessors. A predecessor whose count drops to zero goes to the next level through the buffer of the
+ * thread that released it, so there are no locks besides the barrier between levels.
+ * Levels too small to be worth distributing are evaluated on the calling thread.
+ * @param graph Frozen workflow graph, must be acyclic
+ * @param pool Threads to use
+ * @return Vector of critical weights indexed by job id
+ */
+inline std::vector<int> computeCriticalWeights(const CSRWorkflowGraph& graph, ThreadPool& pool) {
+    const size_t MIN_PARALLEL_LEVEL = 4096;  // smaller levels don't amortize the barrier
+    const size_t CHUNK_SIZE = 256;
+    size_t numJobs = graph.getNumJobs();
+    int numThreads = pool.getNumThreads();
+    std::vector<int> criticalWeights(numJobs, 0);
+    std::vector<std::atomic<int>> pendingSuccessors(numJobs);
+    std::vector<std::vector<JobId>> threadLevels(numThreads);
+
+    // initialize the counters and collect the terminal jobs as the first level
+    pool.parallelFor(0, numJobs, 4 * CHUNK_SIZE, [&](size_t job, int thread) {
+        int outdegree = graph.getOutdegree(job);
+        pendingSuccessors[job].store(outdegree, std::memory_order_relaxed);
+        if (outdegree == 0) {
+            threadLevels[thread].emplace_back(job);
+        }
+    });
+
+    std::vector<JobId> level;
+    for (auto& threadLevel: threadLevels) {
+        level.insert(level.end(), threadLevel.begin(), threadLevel.end());
+        threadLevel.clear();
+    }
+
+    auto evaluate = [&](JobId job, std::vector<JobId>& nextLevel) {
+        int jobCriticalWeight = 0;
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            jobCriticalWeight = std::max(jobCriticalWeight, comm.commTime + criticalWeights[comm.job]);
+        }
+        criticalWeights[job] = jobCriticalWeight + graph.getExecutionTime(job);
+
+        for (const CSREdge& comm: graph.getInEdges(job)) {
+            if (pendingSuccessors[comm.job].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                nextLevel.emplace_back(comm.job);
+            }
+        }
+    };
+
+    std::vector<JobId> nextLevel;
+    while (!level.empty()) {
+        if (numThreads == 1 || level.size() < MIN_PARALLEL_LEVEL) {
+            for (JobId job: level) {
+                evaluate(job, nextLevel);
+            }
+        } else {
+            pool.parallelFor(0, level.size(), CHUNK_SIZE, [&](size_t i, int thread) {
+                evaluate(level[i], threadLevels[thread]);
+            });
+            for (auto& threadLevel: threadLevels) {
+                nextLevel.insert(nextLevel.end(), threadLevel.begin(), threadLevel.end());
+                threadLevel.clear();
+            }
+        }
+        level.swap(nextLevel);
+        nextLevel.clear();
+    }
+
+    return criticalWeights;
+}
+
+/**
+ * Updates the critical weights after some jobs changed, giving the same critical weights as computing them again.
+ * Only the changed jobs and their ancestors can get another critical weight. They are collected first, and then swept
+ * in reverse topological order like in computeCriticalWeights(), every other job keeping its critical weight.
+ * @param graph Frozen workflow graph, must be acyclic
+ * @param changedJobs Jobs added, or whose execution time or outgoing communications changed
+ * @param criticalWeights Critical weights before the change indexed by job id, updated and extended to new jobs
+ * @return Ids of the jobs whose critical weight changed
+ */
+inline std::vector<JobId> updateCriticalWeights(const CSRWorkflowGraph& graph, const std::vector<JobId>& changedJobs,
+                                                std::vector<int>& criticalWeights) {
+    size_t numJobs = graph.getNumJobs();
+    criticalWeights.resize(numJobs, -1);
+
+    // number of successors of each affected job among the affected ones, -1 for the other jobs
+    std::vector<int> pendingSuccessors(numJobs, -1);
+    std::vector<JobId> affectedJobs;
+    for (JobId job: changedJobs) {
+        if (pendingSuccessors[job] < 0) {
+            pendingSuccessors[job] = 0;
+            affectedJobs.emplace_back(job);
+        }
+    }
+    for (size_t head = 0; head < affectedJobs.size(); head++) {
+        for (const CSREdge& comm: graph.getInEdges(affectedJobs[head])) {
+            if (pendingSuccessors[comm.job] < 0) {
+                pendingSuccessors[comm.job] = 0;
+                affectedJobs.emplace_back(comm.job);
+            }
+            pendingSuccessors[comm.job]++;
+        }
+    }
+
+    std::vector<JobId> reverseOrder;
+    reverseOrder.reserve(affectedJobs.size());
+    for (JobId job: affectedJobs) {
+        if (pendingSuccessors[job] == 0) {
+            reverseOrder.emplace_back(job);
+        }
+    }
+
+    std::vector<JobId> updatedJobs;
+    for (size_t head = 0; head < reverseOrder.size(); head++) {
+        JobId job = reverseOrder[head];
+        int jobCriticalWeight = 0;
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            jobCriticalWeight = std::max(jobCriticalWeight, comm.commTime + criticalWeights[comm.job]);
+        }
+        jobCriticalWeight += graph.getExecutionTime(job);
+        if (criticalWeights[job] != jobCriticalWeight) {
+            criticalWeights[job] = jobCriticalWeight;
+            updatedJobs.emplace_back(job);
+        }
+
+        for (const CSREdge& comm: graph.getInEdges(job)) {
+            if (--pendingSuccessors[comm.job] == 0) {
+                reverseOrder.emplace_back(comm.job);
+            }
+        }
+    }
+
+    return updatedJobs;
+}
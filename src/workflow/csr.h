@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+typedef uint32_t JobId;  ///< Dense job index in [0, number of jobs)
+
+/**
+ * Non-owning view over a contiguous array, usable in range-based for loops.
+ */
+template <class T>
+class Span {
+private:
+    const T* first;     ///< First element of the view
+    const T* last;      ///< One past the last element of the view
+public:
+    /**
+     * Constructor for Span.
+     * @param _first First element of the view
+     * @param _last One past the last element of the view
+     */
+    Span(const T* _first, const T* _last): first(_first), last(_last) {}
+
+    const T* begin() const { return first; }
+    const T* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const T& operator[](size_t i) const { return first[i]; }
+};
+
+// Represents one entry of a compressed adjacency array
+struct CSREdge {
+    JobId job;              ///< Neighbouring job (destination for outgoing, source for incoming edges)
+    int commTime;           ///< Time taken for communication between jobs
+};
+
+// Represents a communication added to or removed from a frozen graph, applied later with others in one pass
+struct CSREdit {
+    JobId fromJob;          ///< Source job id of the communication
+    JobId toJob;            ///< Destination job id of the communication
+    int commTime;           ///< Communication time of an added communication
+    bool isRemoval;         ///< Whether all communications from fromJob to toJob are removed instead of one added
+};
+
+/**
+ * Frozen workflow graph in compressed sparse row (CSR) form.
+ * Jobs are identified by dense ids, and the incoming and outgoing communications of every job
+ * are stored contiguously in two flat edge arrays indexed through offset arrays.
+ * The arrays are either owned by the graph or borrowed from external storage, such as a memory-mapped workflow file,
+ * which is only copied into owned arrays once the graph is modified.
+ */
+class CSRWorkflowGraph {
+private:
+    std::vector<int> executionTimes;    ///< Execution time of each job indexed by job id
+    std::vector<uint32_t> outOffsets;   ///< Outgoing edges of job v are outEdges[outOffsets[v], outOffsets[v + 1])
+    std::vector<CSREdge> outEdges;      ///< Outgoing communications grouped by source job
+    std::vector<uint32_t> inOffsets;    ///< Incoming edges of job v are inEdges[inOffsets[v], inOffsets[v + 1])
+    std::vector<CSREdge> inEdges;       ///< Incoming communications grouped by destination job
+    bool isBorrowed = false;            ///< Whether the arrays in use are borrowed instead of the owned ones
+    std::shared_ptr<const void> storage;  ///< Keeps borrowed arrays alive, if any
+
+    // Arrays in use, either the owned ones above or borrowed ones
+    size_t numJobs;                     ///< Number of jobs in the graph
+    size_t numEdges;                    ///< Number of communications in the graph
+    const int* executionTimesData;      ///< Execution time of each job indexed by job id
+    const uint32_t* outOffsetsData;     ///< Offsets of the outgoing communications of each job
+    const CSREdge* outEdgesData;        ///< Outgoing communications grouped by source job
+    const uint32_t* inOffsetsData;      ///< Offsets of the incoming communications of each job
+    const CSREdge* inEdgesData;         ///< Incoming communications grouped by destination job
+
+    /**
+     * Points the arrays in use to the owned arrays, after these were built or modified.
+     */
+    void useOwnedArrays() {
+        isBorrowed = false;
+        storage.reset();
+        numJobs = executionTimes.size();
+        numEdges = outEdges.size();
+        executionTimesData = executionTimes.data();
+        outOffsetsData = outOffsets.data();
+        outEdgesData = outEdges.data();
+        inOffsetsData = inOffsets.data();
+        inEdgesData = inEdges.data();
+    }
+
+    /**
+     * Copies borrowed arrays into owned ones, before the graph is modified.
+     */
+    void ensureOwned() {
+        if (!isBorrowed) {
+            return;
+        }
+        executionTimes.assign(executionTimesData, executionTimesData + numJobs);
+        outOffsets.assign(outOffsetsData, outOffsetsData + numJobs + 1);
+        outEdges.assign(outEdgesData, outEdgesData + numEdges);
+        inOffsets.assign(inOffsetsData, inOffsetsData + numJobs + 1);
+        inEdges.assign(inEdgesData, inEdgesData + numEdges);
+        useOwnedArrays();
+    }
+
+    /**
+     * Takes the arrays in use of another graph after its members were copied or moved, pointing to the owned arrays
+     * of this graph if that one owned its arrays, and to the same borrowed arrays otherwise.
+     * @param other Graph the members come from
+     */
+    void takeArrays(const CSRWorkflowGraph& other) {
+        if (!isBorrowed) {
+            useOwnedArrays();
+            return;
+        }
+        numJobs = other.numJobs;
+        numEdges = other.numEdges;
+        executionTimesData = other.executionTimesData;
+        outOffsetsData = other.outOffsetsData;
+        outEdgesData = other.outEdgesData;
+        inOffsetsData = other.inOffsetsData;
+        inEdgesData = other.inEdgesData;
+    }
+
+    /**
+     * Groups edges by one endpoint with a stable counting sort so that the edges of each job
+     * keep the order in which they were added.
+     * @param numJobs Number of jobs in the graph
+     * @param numEdges Number of communications in the graph
+     * @param keys Endpoint used for grouping
+     * @param others Opposite endpoint stored in the edge entry
+     * @param commTimes Communication time of each edge
+     * @param offsets Resulting offset array
+     * @param edges Resulting edge array
+     */
+    static void buildAdjacency(size_t numJobs, size_t numEdges, const JobId* keys, const JobId* others,
+                               const int* commTimes, std::vector<uint32_t>& offsets, std::vector<CSREdge>& edges) {
+        offsets.assign(numJobs + 1, 0);
+        for (size_t e = 0; e < numEdges; e++) {
+            offsets[keys[e] + 1]++;
+        }
+        for (size_t v = 0; v < numJobs; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        edges.resize(numEdges);
+        for (size_t e = 0; e < numEdges; e++) {
+            CSREdge& edge = edges[cursor[keys[e]]++];
+            edge.job = others[e];
+            edge.commTime = commTimes[e];
+        }
+    }
+
+    /**
+     * Rebuilds one adjacency with edits applied, keeping the edges of every job in order and appending its added
+     * edges after them.
+     * @param offsets Offset array of the adjacency
+     * @param edges Edge array of the adjacency
+     * @param isOutgoing Whether the edges are grouped by source job, or by destination job otherwise
+     * @param additions Communications added and not removed later in the batch, in the order they were added
+     * @param removedPairs Source and destination of the communications removed, packed by packPair()
+     */
+    static void rebuildAdjacency(std::vector<uint32_t>& offsets, std::vector<CSREdge>& edges, bool isOutgoing,
+                                 const std::vector<CSREdit>& additions, const std::unordered_set<uint64_t>& removedPairs) {
+        size_t numJobs = offsets.size() - 1;
+        auto keyOf = [isOutgoing](const CSREdit& edit) { return isOutgoing ? edit.fromJob : edit.toJob; };
+        auto otherOf = [isOutgoing](const CSREdit& edit) { return isOutgoing ? edit.toJob : edit.fromJob; };
+
+        std::vector<CSREdit> sortedAdditions(additions);
+        std::stable_sort(sortedAdditions.begin(), sortedAdditions.end(), [&](const CSREdit& a, const CSREdit& b) {
+            return keyOf(a) < keyOf(b);
+        });
+        std::vector<bool> hasRemovals(numJobs, false);
+        for (uint64_t pair: removedPairs) {
+            hasRemovals[isOutgoing ? pair >> 32 : static_cast<uint32_t>(pair)] = true;
+        }
+
+        std::vector<uint32_t> newOffsets(numJobs + 1, 0);
+        std::vector<CSREdge> newEdges;
+        newEdges.reserve(edges.size() + sortedAdditions.size());
+        size_t nextAddition = 0;
+        for (JobId job = 0; job < numJobs; job++) {
+            for (uint32_t e = offsets[job]; e < offsets[job + 1]; e++) {
+                JobId other = edges[e].job;
+                if (!hasRemovals[job] || !removedPairs.count(isOutgoing ? packPair(job, other) : packPair(other, job))) {
+                    newEdges.emplace_back(edges[e]);
+                }
+            }
+            for (; nextAddition < sortedAdditions.size() && keyOf(sortedAdditions[nextAddition]) == job; nextAddition++) {
+                newEdges.push_back({otherOf(sortedAdditions[nextAddition]), sortedAdditions[nextAddition].commTime});
+            }
+            newOffsets[job + 1] = newEdges.size();
+        }
+        offsets.swap(newOffsets);
+        edges.swap(newEdges);
+    }
+
+    /**
+     * @return Source and destination of a communication packed into one integer
+     */
+    static uint64_t packPair(JobId fromJob, JobId toJob) {
+        return static_cast<uint64_t>(fromJob) << 32 | toJob;
+    }
+public:
+    /**
+     * Constructs an empty graph.
+     */
+    CSRWorkflowGraph(): outOffsets(1, 0), inOffsets(1, 0) {
+        useOwnedArrays();
+    }
+
+    /**
+     * Constructs the graph from job execution times and an edge list given as parallel arrays.
+     * @param numJobs Number of jobs in the graph
+     * @param _executionTimes Execution time of each job indexed by job id
+     * @param numEdges Number of communications in the graph
+     * @param fromJobs Source job id of each communication
+     * @param toJobs Destination job id of each communication
+     * @param commTimes Communication time of each communication
+     */
+    CSRWorkflowGraph(size_t numJobs, const int* _executionTimes, size_t numEdges,
+                     const JobId* fromJobs, const JobId* toJobs, const int* commTimes):
+        executionTimes(_executionTimes, _executionTimes + numJobs) {
+        buildAdjacency(numJobs, numEdges, fromJobs, toJobs, commTimes, outOffsets, outEdges);
+        buildAdjacency(numJobs, numEdges, toJobs, fromJobs, commTimes, inOffsets, inEdges);
+        useOwnedArrays();
+    }
+
+    /**
+     * Constructs the graph over CSR arrays owned by external storage, without copying them.
+     * @param _numJobs Number of jobs in the graph
+     * @param _numEdges Number of communications in the graph
+     * @param _executionTimes Execution time of each job indexed by job id
+     * @param _outOffsets Outgoing edges of job v are _outEdges[_outOffsets[v], _outOffsets[v + 1])
+     * @param _outEdges Outgoing communications grouped by source job
+     * @param _inOffsets Incoming edges of job v are _inEdges[_inOffsets[v], _inOffsets[v + 1])
+     * @param _inEdges Incoming communications grouped by destination job
+     * @param _storage Storage holding the arrays, kept alive as long as the graph or a copy of it uses them, or null
+     *                 if the caller keeps the arrays alive
+     */
+    CSRWorkflowGraph(size_t _numJobs, size_t _numEdges, const int* _executionTimes,
+                     const uint32_t* _outOffsets, const CSREdge* _outEdges,
+                     const uint32_t* _inOffsets, const CSREdge* _inEdges, std::shared_ptr<const void> _storage):
+        isBorrowed(true), storage(std::move(_storage)), numJobs(_numJobs), numEdges(_numEdges), executionTimesData(_executionTimes),
+        outOffsetsData(_outOffsets), outEdgesData(_outEdges), inOffsetsData(_inOffsets), inEdgesData(_inEdges) {}
+
+    CSRWorkflowGraph(const CSRWorkflowGraph& other):
+        executionTimes(other.executionTimes), outOffsets(other.outOffsets), outEdges(other.outEdges),
+        inOffsets(other.inOffsets), inEdges(other.inEdges), isBorrowed(other.isBorrowed), storage(other.storage) {
+        takeArrays(other);
+    }
+
+    CSRWorkflowGraph(CSRWorkflowGraph&& other):
+        executionTimes(std::move(other.executionTimes)), outOffsets(std::move(other.outOffsets)),
+        outEdges(std::move(other.outEdges)), inOffsets(std::move(other.inOffsets)), inEdges(std::move(other.inEdges)),
+        isBorrowed(other.isBorrowed), storage(std::move(other.storage)) {
+        takeArrays(other);
+        other.outOffsets.assign(1, 0);
+        other.inOffsets.assign(1, 0);
+        other.useOwnedArrays();
+    }
+
+    CSRWorkflowGraph& operator=(CSRWorkflowGraph other) {
+        executionTimes.swap(other.executionTimes);
+        outOffsets.swap(other.outOffsets);
+        outEdges.swap(other.outEdges);
+        inOffsets.swap(other.inOffsets);
+        inEdges.swap(other.inEdges);
+        isBorrowed = other.isBorrowed;
+        storage.swap(other.storage);
+        takeArrays(other);
+        return *this;
+    }
+
+    /**
+     * Adds a job with no communications.
+     * @param executionTime Time taken by the job for execution
+     * @return Id of the job
+     */
+    JobId addJob(int executionTime) {
+        ensureOwned();
+        executionTimes.emplace_back(executionTime);
+        outOffsets.emplace_back(outOffsets.back());
+        inOffsets.emplace_back(inOffsets.back());
+        useOwnedArrays();
+        return executionTimes.size() - 1;
+    }
+
+    /**
+     * Changes the execution time of a job.
+     * @param job Job id
+     * @param executionTime Time taken by the job for execution
+     */
+    void setExecutionTime(JobId job, int executionTime) {
+        ensureOwned();
+        executionTimes[job] = executionTime;
+    }
+
+    /**
+     * Applies a batch of communication edits in order, as if the graph was built again with the communications that
+     * remain: the communications of every job keep their order, and added ones come after them in the order they were
+     * added. A removal removes all communications from one job to another, including those added earlier in the batch.
+     * Both adjacencies are rebuilt in a single pass, which takes O(V + E + P log P) for P edits, so edits are best
+     * collected and applied once before the graph is used, rather than one at a time.
+     * @param edits Communications added or removed, in the order of the changes, between jobs already in the graph
+     */
+    void applyEdits(const std::vector<CSREdit>& edits) {
+        if (edits.empty()) {
+            return;
+        }
+
+        // going backwards, an addition survives unless the same communication is removed later
+        std::unordered_set<uint64_t> removedPairs;
+        std::vector<CSREdit> additions;
+        for (auto edit = edits.rbegin(); edit != edits.rend(); ++edit) {
+            uint64_t pair = packPair(edit->fromJob, edit->toJob);
+            if (edit->isRemoval) {
+                removedPairs.insert(pair);
+            } else if (!removedPairs.count(pair)) {
+                additions.emplace_back(*edit);
+            }
+        }
+        std::reverse(additions.begin(), additions.end());
+
+        ensureOwned();
+        rebuildAdjacency(outOffsets, outEdges, true, additions, removedPairs);
+        rebuildAdjacency(inOffsets, inEdges, false, additions, removedPairs);
+        useOwnedArrays();
+    }
+
+    /**
+     * @return Number of jobs in the graph
+     */
+    size_t getNumJobs() const {
+        return numJobs;
+    }
+
+    /**
+     * @return Number of communications in the graph
+     */
+    size_t getNumCommunications() const {
+        return numEdges;
+    }
+
+    /**
+     * @param job Job id
+     * @return Time taken by the job for execution
+     */
+    int getExecutionTime(JobId job) const {
+        return executionTimesData[job];
+    }
+
+    /**
+     * @param job Job id
+     * @return Number of incoming communications of the job
+     */
+    int getIndegree(JobId job) const {
+        return inOffsetsData[job + 1] - inOffsetsData[job];
+    }
+
+    /**
+     * @param job Job id
+     * @return Number of outgoing communications of the job
+     */
+    int getOutdegree(JobId job) const {
+        return outOffsetsData[job + 1] - outOffsetsData[job];
+    }
+
+    /**
+     * Retrieves outgoing communications for a given job without allocating.
+     * @param job Job id
+     * @return View of the outgoing communications, each holding the destination job
+     */
+    Span<CSREdge> getOutEdges(JobId job) const {
+        return Span<CSREdge>(outEdgesData + outOffsetsData[job], outEdgesData + outOffsetsData[job + 1]);
+    }
+
+    /**
+     * Retrieves incoming communications for a given job without allocating.
+     * @param job Job id
+     * @return View of the incoming communications, each holding the source job
+     */
+    Span<CSREdge> getInEdges(JobId job) const {
+        return Span<CSREdge>(inEdgesData + inOffsetsData[job], inEdgesData + inOffsetsData[job + 1]);
+    }
+};
@@ -0,0 +1,404 @@
+#pragma once
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "csr.h"
+#include "placement.h"
+
+// Available orders in which jobs are placed on machines.
+enum class OrderingPolicy {
+    StaticCriticalPath, ///< Jobs are sorted by critical weight upfront and then placed one by one
+    DynamicLevel,       ///< Like DLS, the ready job with the highest critical weight minus earliest start time goes next
+    EarliestTimeFirst   ///< Like ETF, the ready job that can start earliest goes next, the more critical one on ties
+};
+
+/**
+ * Represents a ready job in the dynamic list scheduler along with a priority, as evaluated at some point.
+ */
+struct DynamicReadyJob {
+    int priority;           ///< Priority, or part of it, according to the ordering policy
+    int criticalWeight;     ///< Critical weight of the job, breaking ties in priority
+    JobId job;              ///< Id of the job
+    int machine;            ///< Machine the priority was evaluated for, or -1 for any machine
+
+    /**
+     * Constructor for DynamicReadyJob.
+     * @param _priority Priority according to the ordering policy
+     * @param _criticalWeight Critical weight of the job
+     * @param _job Id of the job
+     * @param _machine Machine the priority was evaluated for
+     */
+    DynamicReadyJob(int _priority, int _criticalWeight, JobId _job, int _machine = -1):
+        priority(_priority), criticalWeight(_criticalWeight), job(_job), machine(_machine) {}
+};
+
+/**
+ * Functor for comparing ready jobs of the dynamic list scheduler.
+ * Higher priority goes first, then higher critical weight, then smaller id.
+ */
+class DynamicReadyJobCompare {
+public:
+    /**
+     * @param j1 First ready job
+     * @param j2 Second ready job
+     * @return True if j1 goes after j2, false otherwise
+     */
+    bool operator()(const DynamicReadyJob& j1, const DynamicReadyJob& j2) const {
+        if (j1.priority != j2.priority) {
+            return j1.priority < j2.priority;
+        }
+        if (j1.criticalWeight != j2.criticalWeight) {
+            return j1.criticalWeight < j2.criticalWeight;
+        }
+        return j1.job > j2.job;
+    }
+};
+
+typedef std::priority_queue<DynamicReadyJob, std::vector<DynamicReadyJob>, DynamicReadyJobCompare> DynamicReadyHeap;
+
+/**
+ * Ready jobs competing for a machine whose start time there is the later of the time their data is ready and a clock,
+ * which only moves forward. The priority of a job is its base priority minus that start time.
+ * Jobs are kept by base priority minus data ready time while their data is ready after the clock, and by base priority
+ * once the clock has passed it, when the clock is the same for all of them. So moving the clock only moves the jobs
+ * whose data became ready, and no priority has to be evaluated again.
+ * Placed jobs are dropped lazily when they show up at the top.
+ */
+class TimedReadyQueue {
+private:
+    // Represents a job waiting for data, with its priority as base priority minus data ready time.
+    struct WaitingJob {
+        int readyTime;              ///< Time when the data of the job is ready
+        DynamicReadyJob readyJob;   ///< Job and its priority
+    };
+
+    // Orders waiting jobs by priority.
+    struct WaitingJobCompare {
+        bool operator()(const WaitingJob& j1, const WaitingJob& j2) const {
+            return DynamicReadyJobCompare()(j1.readyJob, j2.readyJob);
+        }
+    };
+
+    // Orders waiting jobs by data ready time, earliest first.
+    struct DataReadyCompare {
+        bool operator()(const WaitingJob& j1, const WaitingJob& j2) const {
+            return j1.readyTime > j2.readyTime;
+        }
+    };
+
+    int clock = 0;              ///< Earliest start time of any job
+    DynamicReadyHeap readyJobs; ///< Jobs whose data is ready by the clock, by base priority
+    std::priority_queue<WaitingJob, std::vector<WaitingJob>, WaitingJobCompare> waitingJobs;   ///< Other jobs by priority
+    std::priority_queue<WaitingJob, std::vector<WaitingJob>, DataReadyCompare> dataArrivals;  ///< Other jobs by data ready time
+public:
+    /**
+     * @param readyJob Job with its base priority
+     * @param readyTime Time when the data of the job is ready
+     * @return Current priority of the job
+     */
+    int push(DynamicReadyJob readyJob, int readyTime) {
+        if (readyTime <= clock) {
+            readyJobs.push(readyJob);
+            WORKFLOW_STATS_ADD(heapPushes, 1);
+            return readyJob.priority - clock;
+        }
+        readyJob.priority -= readyTime;
+        waitingJobs.push({readyTime, readyJob});
+        dataArrivals.push({readyTime, readyJob});
+        WORKFLOW_STATS_ADD(heapPushes, 2);
+        return readyJob.priority;
+    }
+
+    /**
+     * Moves the clock forward, along with the jobs whose data is ready by then.
+     * @param time New clock, not before the current one
+     */
+    void setClock(int time) {
+        clock = time;
+        while (!dataArrivals.empty() && dataArrivals.top().readyTime <= clock) {
+            DynamicReadyJob readyJob = dataArrivals.top().readyJob;
+            readyJob.priority += dataArrivals.top().readyTime;
+            dataArrivals.pop();
+            readyJobs.push(readyJob);
+            WORKFLOW_STATS_ADD(heapPops, 1);
+            WORKFLOW_STATS_ADD(heapPushes, 1);
+        }
+    }
+
+    /**
+     * Finds the unplaced job with the highest current priority, dropping the placed jobs and the moved waiting jobs
+     * from the tops of the heaps.
+     * @param state Placement of all jobs
+     * @param best Receives the job and its current priority
+     * @return True if there is an unplaced job, false otherwise
+     */
+    bool findBest(const ScheduleState& state, DynamicReadyJob& best) {
+        while (!readyJobs.empty() && state.isScheduled(readyJobs.top().job)) {
+            readyJobs.pop();
+            WORKFLOW_STATS_ADD(heapPops, 1);
+        }
+        while (!waitingJobs.empty() && (waitingJobs.top().readyTime <= clock || state.isScheduled(waitingJobs.top().readyJob.job))) {
+            waitingJobs.pop();
+            WORKFLOW_STATS_ADD(heapPops, 1);
+        }
+        if (readyJobs.empty() && waitingJobs.empty()) {
+            return false;
+        }
+        if (readyJobs.empty()) {
+            best = waitingJobs.top().readyJob;
+            return true;
+        }
+        best = readyJobs.top();
+        best.priority -= clock;
+        if (!waitingJobs.empty() && DynamicReadyJobCompare()(best, waitingJobs.top().readyJob)) {
+            best = waitingJobs.top().readyJob;
+        }
+        return true;
+    }
+};
+
+/**
+ * Single-pass list scheduler choosing the next job among the ready ones by its priority against the partial schedule,
+ * and placing it where it finishes earliest.
+ * The priority of a ready job is its base priority minus its earliest start time, where the base priority is its
+ * critical weight for DLS and zero for ETF. Once a job is ready its predecessors are fixed and machines only get
+ * busier, so its priority never increases.
+ *
+ * With appending, the earliest start time of a job is the smallest of max(machine finish time, data ready time there)
+ * over the machines hosting a predecessor, and of max(earliest machine finish time, data arrival time) for the others.
+ * Every part goes to a TimedReadyQueue, one per machine and one for any machine, whose clock is that finish time, so
+ * the priority of a job is the best of its parts and no job is ever evaluated again. The best job of every queue is
+ * kept in a max heap by the priority it had when pushed, which is never lower than the current one, and the top of the
+ * heap is only trusted once it matches the best job of its queue.
+ * With insertion, any placement may open a gap for any job, so the whole priority is evaluated and kept in a max heap
+ * along with the machine giving it, and a job at the top is evaluated again when that machine got another job since.
+ */
+class DynamicListScheduler {
+private:
+    const CSRWorkflowGraph& graph;          ///< Workflow graph being scheduled
+    const std::vector<int>& criticalWeights;  ///< Critical weight of every job indexed by job id
+    OrderingPolicy orderingPolicy;          ///< Priority of the ready jobs
+    int numMachines;                        ///< Number of machines available for scheduling
+    JobPlacer placer;                       ///< Places jobs on machines
+    ScheduleState state;                    ///< Placement of every job
+
+    // Represents the best job of a queue with its priority when it was found, and the number of times the best job of
+    // the queue was recorded then.
+    struct QueueTop {
+        DynamicReadyJob best;
+        uint32_t version;
+    };
+
+    // Orders queue tops by the priority of their best job.
+    struct QueueTopCompare {
+        bool operator()(const QueueTop& t1, const QueueTop& t2) const {
+            return DynamicReadyJobCompare()(t1.best, t2.best);
+        }
+    };
+
+    // With appending, the part of the priority of every ready job on each machine hosting a predecessor and on any
+    // machine, the last queue, along with the recorded best job of every queue. Only the latest record of a queue
+    // counts, and its priority is never lower than that of the current best job of the queue.
+    std::vector<TimedReadyQueue> queues;
+    std::priority_queue<QueueTop, std::vector<QueueTop>, QueueTopCompare> queueTops;
+    std::vector<DynamicReadyJob> queueBests;
+    std::vector<uint32_t> queueVersions;
+    std::vector<bool> hasQueueBest;
+    std::vector<std::pair<int, int>> machineReadyTimes;
+
+    // With insertion, every ready job by the priority it had when last evaluated, the number of jobs placed on every
+    // machine, and that number for the machine of every job when it was last evaluated.
+    DynamicReadyHeap readyJobs;
+    std::vector<uint32_t> machineVersions;
+    std::vector<uint32_t> jobVersions;
+
+    /**
+     * @param job Id of the job
+     * @return Priority of the job if it could start at time zero
+     */
+    int getBasePriority(JobId job) const {
+        return orderingPolicy == OrderingPolicy::EarliestTimeFirst ? 0 : criticalWeights[job];
+    }
+
+    /**
+     * Evaluates the priority of a ready job with insertion and pushes it to the heap.
+     * @param job Id of the job
+     */
+    void evaluate(JobId job) {
+        Placement placement = placer.findPlacement(graph.getInEdges(job), graph.getExecutionTime(job), state);
+        readyJobs.push(DynamicReadyJob(getBasePriority(job) - placement.startTime, criticalWeights[job], job, placement.machine));
+        WORKFLOW_STATS_ADD(heapPushes, 1);
+        jobVersions[job] = machineVersions[placement.machine];
+    }
+
+    /**
+     * Adds a job whose predecessors are all placed.
+     * @param job Id of the job
+     */
+    void release(JobId job) {
+        if (placer.getPolicy() == PlacementPolicy::Insertion) {
+            evaluate(job);
+            return;
+        }
+
+        DynamicReadyJob readyJob(getBasePriority(job), criticalWeights[job], job);
+        int dataArrivalTime = placer.findDataReadyTimes(graph.getInEdges(job), state, machineReadyTimes);
+        machineReadyTimes.emplace_back(numMachines, dataArrivalTime);
+        DynamicReadyJobCompare less;
+        for (const auto& machineReadyTime: machineReadyTimes) {
+            int queue = machineReadyTime.first;
+            int priority = queues[queue].push(readyJob, machineReadyTime.second);
+            DynamicReadyJob queued(priority, readyJob.criticalWeight, job, queue);
+            if (!hasQueueBest[queue] || less(queueBests[queue], queued)) {
+                recordQueueBest(queued);
+            }
+        }
+    }
+
+    /**
+     * Records the best job of a queue, replacing the previous record.
+     * @param best Best job with its current priority, its machine being the queue
+     */
+    void recordQueueBest(const DynamicReadyJob& best) {
+        queueBests[best.machine] = best;
+        hasQueueBest[best.machine] = true;
+        queueTops.push({best, ++queueVersions[best.machine]});
+        WORKFLOW_STATS_ADD(heapPushes, 1);
+    }
+
+    /**
+     * Finds the ready job with the highest priority.
+     * @param job Receives the id of the job
+     * @return True if there is a ready job, false otherwise
+     */
+    bool selectJob(JobId& job) {
+        if (placer.getPolicy() == PlacementPolicy::Insertion) {
+            while (!readyJobs.empty()) {
+                DynamicReadyJob top = readyJobs.top();
+                if (state.isScheduled(top.job)) {
+                    readyJobs.pop();
+                    WORKFLOW_STATS_ADD(heapPops, 1);
+                } else if (jobVersions[top.job] != machineVersions[top.machine]) {
+                    // its best machine got busier, so its priority may have dropped below that of other ready jobs
+                    readyJobs.pop();
+                    WORKFLOW_STATS_ADD(heapPops, 1);
+                    evaluate(top.job);
+                } else {
+                    job = top.job;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        DynamicReadyJobCompare less;
+        while (!queueTops.empty()) {
+            QueueTop top = queueTops.top();
+            int queue = top.best.machine;
+            if (top.version != queueVersions[queue]) {
+                queueTops.pop();
+                WORKFLOW_STATS_ADD(heapPops, 1);
+                continue;
+            }
+            DynamicReadyJob best = top.best;
+            if (!queues[queue].findBest(state, best)) {
+                queueTops.pop();
+                WORKFLOW_STATS_ADD(heapPops, 1);
+                hasQueueBest[queue] = false;
+                continue;
+            }
+            best.machine = queue;
+            if (!less(best, top.best)) {
+                // every other queue has a best job no better than its record, which is at most this one
+                job = best.job;
+                return true;
+            }
+            queueTops.pop();
+            WORKFLOW_STATS_ADD(heapPops, 1);
+            recordQueueBest(best);
+        }
+        return false;
+    }
+
+    /**
+     * Updates the priorities after placing a job.
+     * @param machine Machine the job was placed on
+     */
+    void advance(int machine) {
+        if (placer.getPolicy() == PlacementPolicy::Insertion) {
+            machineVersions[machine]++;
+        } else {
+            queues[machine].setClock(placer.getFinishTime(machine));
+            queues[numMachines].setClock(placer.getEarliestFinishTime());
+        }
+    }
+public:
+    /**
+     * Constructor for DynamicListScheduler.
+     * @param _graph Frozen workflow graph, must be acyclic
+     * @param _criticalWeights Critical weight of every job indexed by job id
+     * @param _numMachines Number of machines available for scheduling
+     * @param placementPolicy How the start time of a job on a machine is chosen
+     * @param _orderingPolicy Priority of the ready jobs, DynamicLevel or EarliestTimeFirst
+     */
+    DynamicListScheduler(const CSRWorkflowGraph& _graph, const std::vector<int>& _criticalWeights, int _numMachines,
+                         PlacementPolicy placementPolicy, OrderingPolicy _orderingPolicy):
+        graph(_graph), criticalWeights(_criticalWeights), orderingPolicy(_orderingPolicy), numMachines(_numMachines),
+        placer(_numMachines, placementPolicy), state(_graph.getNumJobs()) {
+        if (placementPolicy == PlacementPolicy::Insertion) {
+            machineVersions.assign(numMachines, 0);
+            jobVersions.assign(graph.getNumJobs(), 0);
+        } else {
+            queues.resize(numMachines + 1);
+            queueBests.assign(numMachines + 1, DynamicReadyJob(0, 0, 0));
+            queueVersions.assign(numMachines + 1, 0);
+            hasQueueBest.assign(numMachines + 1, false);
+        }
+    }
+
+    /**
+     * Schedules the workflow on multiple machines and calculates the makespan.
+     * @return Pair containing the makespan and the jobs in the order they were placed
+     */
+    std::pair<int, ScheduleOrder> schedule() {
+        ScheduleOrder scheduleOrder;
+        scheduleOrder.reserve(graph.getNumJobs());
+        int makespan = schedule([&](const ScheduledJob& scheduledJob) { scheduleOrder.emplace_back(scheduledJob); });
+        return {makespan, scheduleOrder};
+    }
+
+    /**
+     * Schedules the workflow on multiple machines, handing every job over as soon as it is placed.
+     * @param emit Called with the scheduling information of every job, in the order they are placed
+     * @return Makespan of the schedule
+     */
+    template <class Emit>
+    int schedule(Emit emit) {
+        size_t numJobs = graph.getNumJobs();
+        std::vector<int> inDegrees(numJobs);
+        for (JobId job = 0; job < numJobs; job++) {
+            inDegrees[job] = graph.getIndegree(job);
+            if (inDegrees[job] == 0) {
+                release(job);
+            }
+        }
+
+        JobId job;
+        while (selectJob(job)) {
+            Placement placement = placer.findPlacement(graph.getInEdges(job), graph.getExecutionTime(job), state);
+            JobPlacer::countCommSkips(graph.getInEdges(job), placement.machine, state);
+            emit(placer.place(job, placement, graph.getExecutionTime(job), state));
+            advance(placement.machine);
+
+            for (const CSREdge& comm: graph.getOutEdges(job)) {
+                if (--inDegrees[comm.job] == 0) {
+                    release(comm.job);
+                }
+            }
+        }
+
+        return placer.getMakespan();
+    }
+};
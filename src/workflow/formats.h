@@ -0,0 +1,1180 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.h"
+#include "reader.h"
+#include "strings.h"
+
+// Text formats a workflow can be read from.
+enum class WorkflowFormat {
+    EdgeList,   ///< Lines "job,executionTime" and "fromJob,toJob,commTime", separated by commas, semicolons or blanks
+    Dot,        ///< Graphviz DOT digraph, with times in the weight, size, time or runtime attribute of nodes and edges
+    Dax,        ///< Pegasus DAX XML, with job runtimes and communication derived from the sizes of the files jobs share
+    WfCommons   ///< WfCommons JSON, any schema version, with runtimes and file sizes as for DAX
+};
+
+// Options for reading a workflow from a text format.
+struct WorkflowReadOptions {
+    double timeScale = 1.0;     ///< Factor turning the times of the file into the integer times of the workflow
+    double bandwidth = 0.0;     ///< Bytes transferred per time unit of the file, used with file sizes, 0 to ignore them
+};
+
+/**
+ * @param value Time as written in the file
+ * @param options Read options
+ * @return True if the time gives a time of the workflow, which is neither negative nor larger than an int
+ */
+inline bool isWorkflowTime(double value, const WorkflowReadOptions& options) {
+    double time = value * options.timeScale;
+    return time > -0.5 && time < INT_MAX + 0.5;  // false for NaN
+}
+
+/**
+ * Converts a time read from a file into the time of the workflow.
+ * @param value Time as written in the file, for which isWorkflowTime() holds
+ * @param options Read options
+ * @return Time of the workflow
+ */
+inline int toWorkflowTime(double value, const WorkflowReadOptions& options) {
+    return static_cast<int>(std::llround(value * options.timeScale));
+}
+
+/**
+ * Looks up a job by name, adding it with no execution time if the workflow has no job with the name yet.
+ * @param graph The workflow
+ * @param name Name of the job
+ * @return Dense id of the job
+ */
+inline JobId findOrAddJob(WorkflowGraph& graph, const std::string& name) {
+    JobId id;
+    return graph.findJobId(name, id) ? id : graph.addJob(name, 0);
+}
+
+/**
+ * Communications of a workflow being read, added at once through the bulk graph builder.
+ */
+class CommunicationBatch {
+private:
+    std::vector<JobId> fromJobs;    ///< Source job of each communication
+    std::vector<JobId> toJobs;      ///< Destination job of each communication
+    std::vector<int> commTimes;     ///< Communication time of each communication
+public:
+    /**
+     * Adds a communication to the batch.
+     * @param fromJob Id of the source job
+     * @param toJob Id of the destination job
+     * @param commTime Time taken for communication between jobs
+     */
+    void add(JobId fromJob, JobId toJob, int commTime) {
+        fromJobs.emplace_back(fromJob);
+        toJobs.emplace_back(toJob);
+        commTimes.emplace_back(commTime);
+    }
+
+    /**
+     * Adds all communications of the batch to a workflow.
+     * @param graph The workflow
+     */
+    void flush(WorkflowGraph& graph) {
+        graph.addCommunications(fromJobs.size(), fromJobs.data(), toJobs.data(), commTimes.data());
+        fromJobs.clear();
+        toJobs.clear();
+        commTimes.clear();
+    }
+};
+
+/**
+ * Reads a workflow from an edge list. Every line holds either a job and its execution time, or a communication as
+ * source job, destination job and communication time. Fields are separated by commas, semicolons or blanks and may
+ * be quoted, "#" starts a comment, and a first line whose last field isn't a number is taken as a header.
+ * Jobs only named in communications have no execution time.
+ * @param path Path of the file
+ * @param graph Workflow receiving the jobs and communications
+ * @param options Read options
+ * @throws std::runtime_error if the file can't be read or a line is malformed
+ */
+inline void readEdgeList(const std::string& path, WorkflowGraph& graph, const WorkflowReadOptions& options = WorkflowReadOptions()) {
+    ChunkedReader reader(path);
+    CommunicationBatch batch;
+    std::string fields[3];
+    bool isFirstLine = true;
+    auto isSeparator = [](int c) { return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\r'; };
+
+    while (reader.peek() != EOF) {
+        size_t numFields = 0, line = reader.getLine();
+        for (int c = reader.peek(); ; c = reader.peek()) {
+            while (isSeparator(c)) {
+                reader.get();
+                c = reader.peek();
+            }
+            if (c == '#') {
+                while (c != '\n' && c != EOF) {
+                    reader.get();
+                    c = reader.peek();
+                }
+            }
+            if (c == '\n' || c == EOF) {
+                reader.get();
+                break;
+            }
+            if (numFields == 3) {
+                throw reader.error("Expected at most 3 fields");
+            }
+
+            std::string& field = fields[numFields++];
+            field.clear();
+            if (reader.accept('"')) {
+                for (c = reader.get(); c != '"' && c != EOF; c = reader.get()) {
+                    field += static_cast<char>(c);
+                }
+                continue;
+            }
+            for (; c != EOF && c != '\n' && c != '#' && !isSeparator(c); c = reader.peek()) {
+                field += static_cast<char>(reader.get());
+            }
+        }
+        if (numFields == 0) {
+            continue;
+        }
+
+        double value;
+        if (numFields == 1 || !parseNumber(fields[numFields - 1], value)) {
+            if (isFirstLine) {
+                isFirstLine = false;
+                continue;
+            }
+            throw reader.error("Expected a job and its execution time, or two jobs and their communication time", line);
+        }
+        isFirstLine = false;
+        if (!isWorkflowTime(value, options)) {
+            throw reader.error("Time is negative or too large", line);
+        }
+        if (numFields == 2) {
+            graph.addJob(fields[0], toWorkflowTime(value, options));
+        } else {
+            batch.add(findOrAddJob(graph, fields[0]), findOrAddJob(graph, fields[1]), toWorkflowTime(value, options));
+        }
+    }
+    batch.flush(graph);
+}
+
+/**
+ * Splits a DOT file into tokens, with one token of lookahead.
+ */
+class DotLexer {
+public:
+    // Kinds of tokens
+    enum Token {
+        End,        ///< End of the file
+        Id,         ///< Identifier, numeral, quoted string or HTML string
+        Edge,       ///< "->" or "--"
+        Symbol      ///< Any other single character
+    };
+private:
+    ChunkedReader& reader;  ///< The file
+    Token pushedBack = End; ///< Kind of the token pushed back, if any
+    bool hasPushedBack = false;  ///< Whether a token was pushed back
+
+    /**
+     * @param c A character
+     * @return True if the character can be part of an unquoted identifier or numeral
+     */
+    static bool isIdChar(int c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.' || c >= 0x80;
+    }
+
+    /**
+     * Consumes blanks and comments.
+     */
+    void skipBlanks() {
+        while (true) {
+            reader.skipWhitespace();
+            int c = reader.peek();
+            if (c == '#') {
+                reader.skipPast('\n');
+            } else if (c == '/') {
+                reader.get();
+                if (reader.accept('/')) {
+                    reader.skipPast('\n');
+                } else if (reader.accept('*')) {
+                    reader.skipPast("*/");
+                } else {
+                    throw reader.error("Unexpected '/'");
+                }
+            } else {
+                return;
+            }
+        }
+    }
+public:
+    std::string text;       ///< Text of the last token, unquoted
+
+    /**
+     * Constructor for DotLexer.
+     * @param _reader The file
+     */
+    explicit DotLexer(ChunkedReader& _reader): reader(_reader) {}
+
+    /**
+     * Reads the next token into text.
+     * @return Kind of the token
+     */
+    Token next() {
+        if (hasPushedBack) {
+            hasPushedBack = false;
+            return pushedBack;
+        }
+        skipBlanks();
+        int c = reader.get();
+        text.clear();
+        if (c == EOF) {
+            return pushedBack = End;
+        }
+        if (c == '"') {
+            for (c = reader.get(); c != '"' && c != EOF; c = reader.get()) {
+                if (c == '\\' && (reader.peek() == '"' || reader.peek() == '\\')) {
+                    c = reader.get();
+                }
+                text += static_cast<char>(c);
+            }
+            return pushedBack = Id;
+        }
+        if (c == '<') {
+            for (int depth = 1; depth > 0 && (c = reader.get()) != EOF; ) {
+                depth += c == '<' ? 1 : (c == '>' ? -1 : 0);
+                if (depth > 0) {
+                    text += static_cast<char>(c);
+                }
+            }
+            return pushedBack = Id;
+        }
+        if (c == '-' && (reader.peek() == '>' || reader.peek() == '-')) {
+            reader.get();
+            return pushedBack = Edge;
+        }
+        if (isIdChar(c) || c == '-') {
+            text += static_cast<char>(c);
+            while (isIdChar(reader.peek())) {
+                text += static_cast<char>(reader.get());
+            }
+            return pushedBack = Id;
+        }
+        text += static_cast<char>(c);
+        return pushedBack = Symbol;
+    }
+
+    /**
+     * Makes the next call to next() return the last token again. The text of the token must be left as it is.
+     */
+    void pushBack() {
+        hasPushedBack = true;
+    }
+
+    /**
+     * Builds the exception for a syntax error at the current line.
+     * @param message Description of the error
+     * @return Exception to throw
+     */
+    std::runtime_error error(const std::string& message) const {
+        return reader.error(message);
+    }
+};
+
+/**
+ * Reads one or more attribute lists of DOT, after their opening bracket was consumed, and finds a time in them.
+ * @param lexer The lexer
+ * @param value Set to the value of the first attribute named weight, size, time, runtime or comm, if any
+ * @return True if a time was found, false otherwise
+ */
+inline bool readDotTime(DotLexer& lexer, double& value) {
+    bool isFound = false;
+    while (true) {
+        DotLexer::Token token = lexer.next();
+        if (token == DotLexer::End) {
+            throw lexer.error("Unterminated attribute list");
+        }
+        if (token == DotLexer::Symbol && lexer.text == "]") {
+            if (lexer.next() == DotLexer::Symbol && lexer.text == "[") {
+                continue;
+            }
+            lexer.pushBack();
+            return isFound;
+        }
+        if (token != DotLexer::Id) {
+            continue;
+        }
+
+        std::string name = lexer.text;
+        if (lexer.next() != DotLexer::Symbol || lexer.text != "=") {
+            lexer.pushBack();
+            continue;
+        }
+        if (lexer.next() != DotLexer::Id) {
+            throw lexer.error("Expected a value for attribute " + name);
+        }
+        bool isTime = name == "weight" || name == "size" || name == "time" || name == "runtime" || name == "comm";
+        if (isTime && !isFound) {
+            isFound = parseNumber(lexer.text, value);
+        }
+    }
+}
+
+/**
+ * Reads a workflow from a DOT digraph. Nodes are jobs, with their execution time in the weight, size, time or runtime
+ * attribute, and edges, chained or not, are communications with their time in the same attributes or comm.
+ * Graph, node and edge default attributes and subgraphs used as statement blocks are accepted and ignored.
+ * @param path Path of the file
+ * @param graph Workflow receiving the jobs and communications
+ * @param options Read options
+ * @throws std::runtime_error if the file can't be read or is malformed
+ */
+inline void readDot(const std::string& path, WorkflowGraph& graph, const WorkflowReadOptions& options = WorkflowReadOptions()) {
+    ChunkedReader reader(path);
+    DotLexer lexer(reader);
+    CommunicationBatch batch;
+    std::vector<JobId> chain;
+    double value;
+
+    for (DotLexer::Token token = lexer.next(); token != DotLexer::End; token = lexer.next()) {
+        if (token != DotLexer::Id) {
+            if (token == DotLexer::Symbol && lexer.text == "[") {
+                readDotTime(lexer, value);
+            } else if (token == DotLexer::Edge) {
+                throw lexer.error("Subgraphs as edge endpoints are not supported");
+            }
+            continue;
+        }
+
+        std::string keyword = lexer.text;
+        std::transform(keyword.begin(), keyword.end(), keyword.begin(), ::tolower);
+        if (keyword == "strict") {
+            continue;
+        }
+        if (keyword == "graph" || keyword == "digraph" || keyword == "subgraph" || keyword == "node" || keyword == "edge") {
+            if (lexer.next() != DotLexer::Id) {
+                lexer.pushBack();
+            }
+            continue;
+        }
+
+        // a statement starting with a node id is a graph attribute, a node or a chain of edges, ports being ignored
+        std::string name = lexer.text;
+        token = lexer.next();
+        if (token == DotLexer::Symbol && lexer.text == "=") {
+            lexer.next();
+            continue;
+        }
+        chain.clear();
+        chain.emplace_back(findOrAddJob(graph, name));
+        while (true) {
+            while (token == DotLexer::Symbol && lexer.text == ":") {
+                lexer.next();
+                token = lexer.next();
+            }
+            if (token != DotLexer::Edge) {
+                break;
+            }
+            if (lexer.next() != DotLexer::Id) {
+                throw lexer.error("Subgraphs as edge endpoints are not supported");
+            }
+            chain.emplace_back(findOrAddJob(graph, lexer.text));
+            token = lexer.next();
+        }
+
+        bool hasTime = token == DotLexer::Symbol && lexer.text == "[" && readDotTime(lexer, value);
+        if (hasTime && !isWorkflowTime(value, options)) {
+            throw lexer.error("Time is negative or too large");
+        }
+        if (!(token == DotLexer::Symbol && lexer.text == "[")) {
+            lexer.pushBack();
+        }
+        if (chain.size() == 1) {
+            if (hasTime) {
+                graph.addJob(name, toWorkflowTime(value, options));
+            }
+            continue;
+        }
+        int commTime = hasTime ? toWorkflowTime(value, options) : 0;
+        for (size_t i = 1; i < chain.size(); i++) {
+            batch.add(chain[i - 1], chain[i], commTime);
+        }
+    }
+    batch.flush(graph);
+}
+
+/**
+ * Tasks of a DAX or WfCommons workflow being read, along with their dependencies and the files they read and write.
+ * Tasks may be referenced before they are described, so everything is resolved once the whole file is read.
+ * The communication time of a dependency is the time to transfer the files the child reads and the parent writes.
+ */
+class TaskCollector {
+private:
+    enum : uint32_t { NONE = 0xFFFFFFFFu };  ///< No task
+
+    // Represents a file read by a task.
+    struct FileInput {
+        uint32_t task;      ///< The task
+        uint32_t file;      ///< The file
+        double size;        ///< Size of the file in bytes, negative if given elsewhere
+    };
+
+    StringTable tasks;                  ///< Key of every task, its id if it has one and its name otherwise
+    std::vector<double> runtimes;       ///< Runtime of every task
+    StringTable aliases;                ///< Other name of every task known under two
+    std::vector<uint32_t> aliasTasks;   ///< Task of every alias
+    StringTable refs;                   ///< Task references used in dependencies
+    std::vector<std::pair<uint32_t, uint32_t>> dependencies;  ///< Child and parent reference of every dependency
+    StringTable files;                  ///< Name of every file
+    std::vector<double> fileSizes;      ///< Size of every file in bytes, negative if unknown
+    std::vector<uint32_t> producers;    ///< Task writing every file, NONE if none
+    std::vector<FileInput> inputs;      ///< Files read by every task
+
+    /**
+     * @param name Name of a file
+     * @return Id of the file
+     */
+    uint32_t addFile(const std::string& name) {
+        bool isNew;
+        uint32_t file = files.intern(name.data(), name.size(), isNew);
+        if (isNew) {
+            fileSizes.emplace_back(-1);
+            producers.emplace_back(NONE);
+        }
+        return file;
+    }
+
+    /**
+     * Resolves a task reference.
+     * @param ref Id of the reference
+     * @return The task
+     * @throws std::runtime_error if no task has the key or name referenced
+     */
+    uint32_t resolve(uint32_t ref) const {
+        uint32_t task;
+        if (tasks.find(refs.get(ref), refs.getLength(ref), task)) {
+            return task;
+        }
+        if (aliases.find(refs.get(ref), refs.getLength(ref), task)) {
+            return aliasTasks[task];
+        }
+        throw std::runtime_error(std::string("Unknown task: ") + refs.get(ref));
+    }
+public:
+    /**
+     * Adds a task, or finds it if it was added before.
+     * @param key Id of the task if it has one, and its name otherwise
+     * @return The task
+     */
+    uint32_t addTask(const std::string& key) {
+        bool isNew;
+        uint32_t task = tasks.intern(key.data(), key.size(), isNew);
+        if (isNew) {
+            runtimes.emplace_back(0);
+        }
+        return task;
+    }
+
+    /**
+     * @param task The task
+     * @param runtime Runtime of the task in time units of the file
+     */
+    void setRuntime(uint32_t task, double runtime) {
+        runtimes[task] = runtime;
+    }
+
+    /**
+     * Makes a task also known under another name, used by dependencies in some formats.
+     * @param name Other name of the task
+     * @param task The task
+     */
+    void addAlias(const std::string& name, uint32_t task) {
+        bool isNew;
+        aliases.intern(name.data(), name.size(), isNew);
+        if (isNew) {
+            aliasTasks.emplace_back(task);
+        }
+    }
+
+    /**
+     * Adds a dependency between tasks, which may not be added yet.
+     * @param childRef Key or name of the task depending on the other
+     * @param parentRef Key or name of the task depended upon
+     */
+    void addDependency(const std::string& childRef, const std::string& parentRef) {
+        uint32_t child = refs.intern(childRef), parent = refs.intern(parentRef);
+        dependencies.emplace_back(child, parent);
+    }
+
+    /**
+     * Records that a task reads a file.
+     * @param task The task
+     * @param name Name of the file
+     * @param size Size of the file in bytes, negative if given elsewhere
+     */
+    void addInput(uint32_t task, const std::string& name, double size) {
+        inputs.push_back({task, addFile(name), size});
+    }
+
+    /**
+     * Records that a task writes a file.
+     * @param task The task
+     * @param name Name of the file
+     * @param size Size of the file in bytes, negative if given elsewhere
+     */
+    void addOutput(uint32_t task, const std::string& name, double size) {
+        uint32_t file = addFile(name);
+        producers[file] = task;
+        if (size >= 0) {
+            fileSizes[file] = size;
+        }
+    }
+
+    /**
+     * @param name Name of a file
+     * @param size Size of the file in bytes
+     */
+    void setFileSize(const std::string& name, double size) {
+        fileSizes[addFile(name)] = size;
+    }
+
+    /**
+     * Adds the tasks as jobs named by their key, and the dependencies as communications, to a workflow.
+     * @param graph The workflow
+     * @param options Read options
+     * @throws std::runtime_error if a dependency references an unknown task, or its files take too long to transfer
+     */
+    void build(WorkflowGraph& graph, const WorkflowReadOptions& options) {
+        std::vector<JobId> jobs(tasks.size());
+        std::string name;
+        for (uint32_t task = 0; task < tasks.size(); task++) {
+            name.assign(tasks.get(task), tasks.getLength(task));
+            jobs[task] = graph.addJob(name, toWorkflowTime(runtimes[task], options));
+        }
+
+        // group the resolved dependencies and the inputs by child, and sum the bytes every child gets from each parent
+        std::vector<std::pair<uint32_t, uint32_t>> resolved;
+        resolved.reserve(dependencies.size());
+        for (const auto& dependency: dependencies) {
+            resolved.emplace_back(resolve(dependency.first), resolve(dependency.second));
+        }
+        std::sort(resolved.begin(), resolved.end());
+        resolved.erase(std::unique(resolved.begin(), resolved.end()), resolved.end());
+        std::sort(inputs.begin(), inputs.end(), [](const FileInput& i1, const FileInput& i2) { return i1.task < i2.task; });
+
+        CommunicationBatch batch;
+        std::vector<double> bytesFrom(tasks.size(), 0);
+        size_t nextInput = 0;
+        for (size_t first = 0, last; first < resolved.size(); first = last) {
+            uint32_t child = resolved[first].first;
+            for (last = first; last < resolved.size() && resolved[last].first == child; last++) {
+            }
+
+            while (nextInput < inputs.size() && inputs[nextInput].task < child) {
+                nextInput++;
+            }
+            size_t firstInput = nextInput;
+            for (; nextInput < inputs.size() && inputs[nextInput].task == child; nextInput++) {
+                const FileInput& input = inputs[nextInput];
+                uint32_t producer = producers[input.file];
+                double size = input.size >= 0 ? input.size : fileSizes[input.file];
+                if (producer != NONE && size > 0) {
+                    bytesFrom[producer] += size;
+                }
+            }
+
+            for (size_t i = first; i < last; i++) {
+                uint32_t parent = resolved[i].second;
+                double commTime = options.bandwidth > 0 ? bytesFrom[parent] / options.bandwidth : 0;
+                if (!isWorkflowTime(commTime, options)) {
+                    name.assign(tasks.get(child), tasks.getLength(child));
+                    throw std::runtime_error("Communication time too large for the files read by task " + name);
+                }
+                batch.add(jobs[parent], jobs[child], toWorkflowTime(commTime, options));
+            }
+            for (size_t i = firstInput; i < nextInput; i++) {
+                if (producers[inputs[i].file] != NONE) {
+                    bytesFrom[producers[inputs[i].file]] = 0;
+                }
+            }
+        }
+        batch.flush(graph);
+    }
+};
+
+/**
+ * Replaces the XML entities of a string by the characters they stand for.
+ * @param str The string
+ */
+inline void decodeXmlEntities(std::string& str) {
+    static const char* const entities[][2] = {{"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&apos;", "'"}, {"&amp;", "&"}};
+    if (str.find('&') == std::string::npos) {
+        return;
+    }
+    for (const auto& entity: entities) {
+        for (size_t at = str.find(entity[0]); at != std::string::npos; at = str.find(entity[0], at + 1)) {
+            str.replace(at, std::strlen(entity[0]), entity[1]);
+        }
+    }
+}
+
+/**
+ * Reads a workflow from a Pegasus DAX file. Every job, dax or dag element is a job named by its id, with its runtime
+ * attribute as execution time, and every parent of a child element is a communication. The communication time is
+ * the total size of the files the child uses as input and the parent as output, divided by the bandwidth.
+ * Only the elements and attributes used are looked at, without building a document tree.
+ * @param path Path of the file
+ * @param graph Workflow receiving the jobs and communications
+ * @param options Read options
+ * @throws std::runtime_error if the file can't be read or is malformed
+ */
+inline void readDax(const std::string& path, WorkflowGraph& graph, const WorkflowReadOptions& options = WorkflowReadOptions()) {
+    ChunkedReader reader(path);
+    TaskCollector tasks;
+    std::string element, attribute, value;
+    std::string id, ref, file, link, child;
+    double runtime, size;
+    bool hasRuntime;
+    uint32_t job = 0;
+    bool isInJob = false, isInChild = false;
+    auto isNameEnd = [](int c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '/' || c == '>' || c == '=' || c == EOF; };
+
+    for (int c = reader.get(); c != EOF; c = reader.get()) {
+        if (c != '<') {
+            continue;
+        }
+        if (reader.accept('?')) {
+            reader.skipPast("?>");
+            continue;
+        }
+        if (reader.accept('!')) {
+            if (reader.accept('-')) {
+                reader.skipPast("-->");
+            } else {
+                reader.skipPast('>');
+            }
+            continue;
+        }
+        bool isClosing = reader.accept('/');
+        element.clear();
+        while (!isNameEnd(reader.peek())) {
+            element += static_cast<char>(reader.get());
+        }
+        element.erase(0, element.find(':') + 1);
+        bool isJob = element == "job" || element == "dax" || element == "dag";
+        if (isClosing) {
+            reader.skipPast('>');
+            isInJob = isInJob && !isJob;
+            isInChild = isInChild && element != "child";
+            continue;
+        }
+
+        id.clear();
+        ref.clear();
+        file.clear();
+        link.clear();
+        hasRuntime = false;
+        size = -1;
+        bool isSelfClosing = false;
+        while (true) {
+            reader.skipWhitespace();
+            if (reader.accept('>')) {
+                break;
+            }
+            if (reader.accept('/')) {
+                isSelfClosing = true;
+                continue;
+            }
+            if (reader.peek() == EOF) {
+                throw reader.error("Unterminated element " + element);
+            }
+            attribute.clear();
+            while (!isNameEnd(reader.peek())) {
+                attribute += static_cast<char>(reader.get());
+            }
+            reader.skipWhitespace();
+            if (!reader.accept('=')) {
+                throw reader.error("Expected '=' after attribute " + attribute);
+            }
+            reader.skipWhitespace();
+            int quote = reader.get();
+            if (quote != '"' && quote != '\'') {
+                throw reader.error("Expected a quoted value for attribute " + attribute);
+            }
+            value.clear();
+            for (c = reader.get(); c != quote && c != EOF; c = reader.get()) {
+                value += static_cast<char>(c);
+            }
+            decodeXmlEntities(value);
+
+            if (attribute == "id") {
+                id = value;
+            } else if (attribute == "ref") {
+                ref = value;
+            } else if (attribute == "file" || (attribute == "name" && element == "uses")) {
+                file = value;
+            } else if (attribute == "link") {
+                link = value;
+            } else if (attribute == "runtime") {
+                hasRuntime = parseNumber(value, runtime);
+            } else if (attribute == "size") {
+                parseNumber(value, size);
+            }
+        }
+
+        if (isJob && !id.empty()) {
+            job = tasks.addTask(id);
+            if (hasRuntime) {
+                if (!isWorkflowTime(runtime, options)) {
+                    throw reader.error("Runtime is negative or too large");
+                }
+                tasks.setRuntime(job, runtime);
+            }
+            isInJob = !isSelfClosing;
+        } else if (element == "uses" && isInJob && !file.empty()) {
+            if (link == "output") {
+                tasks.addOutput(job, file, size);
+            } else {
+                tasks.addInput(job, file, size);
+            }
+        } else if (element == "child") {
+            child = ref;
+            isInChild = !isSelfClosing;
+        } else if (element == "parent" && isInChild) {
+            tasks.addDependency(child, ref);
+        }
+    }
+    tasks.build(graph, options);
+}
+
+/**
+ * Pulls the values of a JSON document one at a time, without building a document tree.
+ */
+class JsonReader {
+private:
+    ChunkedReader& reader;  ///< The file
+
+    /**
+     * Reads the 4 hexadecimal digits of a unicode escape.
+     * @return The UTF-16 code unit
+     * @throws std::runtime_error if there aren't 4 hexadecimal digits
+     */
+    unsigned readCodeUnit() {
+        unsigned code = 0;
+        for (int i = 0; i < 4; i++) {
+            int c = reader.get();
+            if (!std::isxdigit(c)) {
+                throw reader.error("Expected 4 hexadecimal digits after \\u");
+            }
+            code = code * 16 + (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+        }
+        return code;
+    }
+public:
+    /**
+     * Constructor for JsonReader.
+     * @param _reader The file
+     */
+    explicit JsonReader(ChunkedReader& _reader): reader(_reader) {}
+
+    /**
+     * @return First character of the next value or structural character, without consuming it
+     */
+    int peek() {
+        reader.skipWhitespace();
+        return reader.peek();
+    }
+
+    /**
+     * Consumes the next structural character if it is the given one.
+     * @param c Expected character
+     * @return True if it was consumed, false otherwise
+     */
+    bool accept(int c) {
+        reader.skipWhitespace();
+        return reader.accept(c);
+    }
+
+    /**
+     * Consumes the given structural character.
+     * @param c Expected character
+     * @throws std::runtime_error if the next character is another one
+     */
+    void expect(int c) {
+        if (!accept(c)) {
+            throw reader.error(std::string("Expected '") + static_cast<char>(c) + "'");
+        }
+    }
+
+    /**
+     * Reads a string value, with escapes replaced by the characters they stand for in UTF-8.
+     * @param str Receives the string
+     */
+    void readString(std::string& str) {
+        expect('"');
+        str.clear();
+        for (int c = reader.get(); c != '"'; c = reader.get()) {
+            if (c == EOF) {
+                throw reader.error("Unterminated string");
+            }
+            if (c != '\\') {
+                str += static_cast<char>(c);
+                continue;
+            }
+            c = reader.get();
+            switch (c) {
+            case 'b': str += '\b'; break;
+            case 'f': str += '\f'; break;
+            case 'n': str += '\n'; break;
+            case 'r': str += '\r'; break;
+            case 't': str += '\t'; break;
+            case 'u': {
+                unsigned code = readCodeUnit();
+                if (code >= 0xDC00 && code <= 0xDFFF) {
+                    throw reader.error("Unpaired low surrogate in string");
+                }
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    unsigned low = reader.accept('\\') && reader.accept('u') ? readCodeUnit() : 0;
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        throw reader.error("Unpaired high surrogate in string");
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                if (code < 0x80) {
+                    str += static_cast<char>(code);
+                } else if (code < 0x800) {
+                    str += static_cast<char>(0xC0 | (code >> 6));
+                    str += static_cast<char>(0x80 | (code & 0x3F));
+                } else if (code < 0x10000) {
+                    str += static_cast<char>(0xE0 | (code >> 12));
+                    str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    str += static_cast<char>(0x80 | (code & 0x3F));
+                } else {
+                    str += static_cast<char>(0xF0 | (code >> 18));
+                    str += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    str += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default: str += static_cast<char>(c);
+            }
+        }
+    }
+
+    /**
+     * Reads a number value, a string holding a number, or null.
+     * @param value Receives the number, or zero if the value is another string, unchanged if it is null
+     * @return False if the value is null, true otherwise
+     * @throws std::runtime_error if the value is neither a number, a string nor null
+     */
+    bool readNumber(double& value) {
+        std::string& text = scratch;
+        int c = peek();
+        if (c == '"') {
+            readString(text);
+        } else if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.') {
+            text.clear();
+            for (; (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'; c = reader.peek()) {
+                text += static_cast<char>(reader.get());
+            }
+        } else {
+            text.clear();
+            for (; c >= 'a' && c <= 'z'; c = reader.peek()) {
+                text += static_cast<char>(reader.get());
+            }
+            if (text == "null") {
+                return false;
+            }
+            if (text.empty()) {
+                throw reader.error(c == EOF ? "Unexpected end of file" : std::string("Expected a number, got '") + static_cast<char>(c) + "'");
+            }
+            throw reader.error("Expected a number, got " + text);
+        }
+        if (!parseNumber(text, value)) {
+            value = 0;
+        }
+        return true;
+    }
+
+    /**
+     * Consumes the next value, whatever it is.
+     */
+    void skipValue() {
+        int c = peek();
+        if (c == '"') {
+            readString(scratch);
+        } else if (c == '{' || c == '[') {
+            int close = c == '{' ? '}' : ']';
+            reader.get();
+            if (accept(close)) {
+                return;
+            }
+            do {
+                if (c == '{') {
+                    readString(scratch);
+                    expect(':');
+                }
+                skipValue();
+            } while (accept(','));
+            expect(close);
+        } else if (c == EOF) {
+            throw reader.error("Unexpected end of file");
+        } else {
+            for (c = reader.peek(); c != ',' && c != '}' && c != ']' && c != EOF; c = reader.peek()) {
+                reader.get();
+            }
+        }
+    }
+
+    /**
+     * Iterates over the members of an object value, the next value having to be read by the caller for each member.
+     * @param key Receives the key of the next member
+     * @param isFirst Whether the object is just starting, set to false
+     * @return True if there is a member, false at the end of the object
+     */
+    bool nextMember(std::string& key, bool& isFirst) {
+        if (isFirst) {
+            isFirst = false;
+            expect('{');
+            if (accept('}')) {
+                return false;
+            }
+        } else if (!accept(',')) {
+            expect('}');
+            return false;
+        }
+        readString(key);
+        expect(':');
+        return true;
+    }
+
+    /**
+     * Iterates over the elements of an array value, the next value having to be read by the caller for each element.
+     * @param isFirst Whether the array is just starting, set to false
+     * @return True if there is an element, false at the end of the array
+     */
+    bool nextElement(bool& isFirst) {
+        if (isFirst) {
+            isFirst = false;
+            expect('[');
+            return !accept(']');
+        }
+        if (!accept(',')) {
+            expect(']');
+            return false;
+        }
+        return true;
+    }
+
+    std::string scratch;    ///< Text of values that are skipped or converted
+};
+
+/**
+ * Reads a workflow from a WfCommons JSON file, of any schema version. Every element of an array named tasks is a task,
+ * described by its id or name, its runtime or runtimeInSeconds, its parents, and its files, either as objects with a
+ * link and a size or sizeInBytes, or as ids in inputFiles and outputFiles with sizes in an array named files. A task
+ * described twice, like in the specification and execution parts of the newer schema, is merged into one job named
+ * by its id if it has one. A null runtime or size counts as missing. The communication time is derived from the sizes of
+ * the files as for DAX.
+ * @param path Path of the file
+ * @param graph Workflow receiving the jobs and communications
+ * @param options Read options
+ * @throws std::runtime_error if the file can't be read or is malformed
+ */
+inline void readWfCommons(const std::string& path, WorkflowGraph& graph, const WorkflowReadOptions& options = WorkflowReadOptions()) {
+    ChunkedReader reader(path);
+    JsonReader json(reader);
+    TaskCollector tasks;
+
+    // members of the task being read, reused from task to task
+    std::string key, id, name, fileName, fileLink;
+    std::vector<std::string> parents, inputNames, outputNames;
+    std::vector<double> inputSizes, outputSizes;
+    size_t numParents, numInputs, numOutputs;
+    double runtime, fileSize;
+    bool hasRuntime;
+    auto append = [](std::vector<std::string>& strings, size_t& count) -> std::string& {
+        if (count == strings.size()) {
+            strings.emplace_back();
+        }
+        return strings[count++];
+    };
+
+    // reads a file as an object with a name and a size, or as the name alone
+    auto readFile = [&]() {
+        fileName.clear();
+        fileLink.clear();
+        fileSize = -1;
+        if (json.peek() == '"') {
+            json.readString(fileName);
+            return;
+        }
+        bool isFirst = true;
+        while (json.nextMember(key, isFirst)) {
+            if ((key == "name" || key == "id" || key == "file") && json.peek() == '"') {
+                json.readString(fileName);
+            } else if (key == "link" && json.peek() == '"') {
+                json.readString(fileLink);
+            } else if (key == "size" || key == "sizeInBytes") {
+                json.readNumber(fileSize);
+            } else {
+                json.skipValue();
+            }
+        }
+    };
+    auto readFiles = [&](std::vector<std::string>& names, std::vector<double>& sizes, size_t& count, const char* link) {
+        bool isFirst = true;
+        while (json.nextElement(isFirst)) {
+            readFile();
+            bool isOutput = fileLink.empty() ? std::string(link) == "output" : fileLink == "output";
+            std::vector<std::string>& targetNames = isOutput ? outputNames : names;
+            size_t& targetCount = isOutput ? numOutputs : count;
+            std::vector<double>& targetSizes = isOutput ? outputSizes : sizes;
+            append(targetNames, targetCount) = fileName;
+            targetSizes.resize(targetNames.size());
+            targetSizes[targetCount - 1] = fileSize;
+        }
+    };
+
+    auto readTask = [&]() {
+        id.clear();
+        name.clear();
+        numParents = numInputs = numOutputs = 0;
+        hasRuntime = false;
+        bool isFirst = true;
+        while (json.nextMember(key, isFirst)) {
+            if (key == "id" && json.peek() == '"') {
+                json.readString(id);
+            } else if (key == "name" && json.peek() == '"') {
+                json.readString(name);
+            } else if (key == "runtime" || key == "runtimeInSeconds") {
+                hasRuntime = json.readNumber(runtime);
+            } else if (key == "parents" && json.peek() == '[') {
+                bool isFirstParent = true;
+                while (json.nextElement(isFirstParent)) {
+                    json.readString(append(parents, numParents));
+                }
+            } else if (key == "files" && json.peek() == '[') {
+                readFiles(inputNames, inputSizes, numInputs, "input");
+            } else if (key == "inputFiles" && json.peek() == '[') {
+                readFiles(inputNames, inputSizes, numInputs, "input");
+            } else if (key == "outputFiles" && json.peek() == '[') {
+                readFiles(outputNames, outputSizes, numOutputs, "output");
+            } else {
+                json.skipValue();
+            }
+        }
+
+        const std::string& taskKey = id.empty() ? name : id;
+        if (taskKey.empty()) {
+            throw reader.error("Task without id or name");
+        }
+        uint32_t task = tasks.addTask(taskKey);
+        if (!id.empty() && !name.empty() && name != id) {
+            tasks.addAlias(name, task);
+        }
+        if (hasRuntime) {
+            if (!isWorkflowTime(runtime, options)) {
+                throw reader.error("Runtime is negative or too large");
+            }
+            tasks.setRuntime(task, runtime);
+        }
+        for (size_t i = 0; i < numParents; i++) {
+            tasks.addDependency(taskKey, parents[i]);
+        }
+        for (size_t i = 0; i < numInputs; i++) {
+            tasks.addInput(task, inputNames[i], inputSizes[i]);
+        }
+        for (size_t i = 0; i < numOutputs; i++) {
+            tasks.addOutput(task, outputNames[i], outputSizes[i]);
+        }
+    };
+
+    // walks the objects looking for arrays of tasks and of files, skipping everything else
+    std::function<void()> readObject = [&]() {
+        std::string member;
+        bool isFirst = true;
+        while (json.nextMember(member, isFirst)) {
+            int c = json.peek();
+            if (member == "tasks" && c == '[') {
+                bool isFirstTask = true;
+                while (json.nextElement(isFirstTask)) {
+                    readTask();
+                }
+            } else if (member == "files" && c == '[') {
+                bool isFirstFile = true;
+                while (json.nextElement(isFirstFile)) {
+                    readFile();
+                    if (!fileName.empty() && fileSize >= 0) {
+                        tasks.setFileSize(fileName, fileSize);
+                    }
+                }
+            } else if (c == '{') {
+                readObject();
+            } else {
+                json.skipValue();
+            }
+        }
+    };
+    if (json.peek() != '{') {
+        throw reader.error("Expected a JSON object");
+    }
+    readObject();
+    tasks.build(graph, options);
+}
+
+/**
+ * Guesses the format of a workflow file from its extension: .dax and .xml for DAX, .json for WfCommons, .dot and .gv
+ * for DOT, and an edge list otherwise.
+ * @param path Path of the file
+ * @return Format of the file
+ */
+inline WorkflowFormat guessWorkflowFormat(const std::string& path) {
+    std::string extension = path.substr(path.find_last_of('.') == std::string::npos ? path.size() : path.find_last_of('.'));
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".dax" || extension == ".xml") {
+        return WorkflowFormat::Dax;
+    }
+    if (extension == ".json") {
+        return WorkflowFormat::WfCommons;
+    }
+    if (extension == ".dot" || extension == ".gv") {
+        return WorkflowFormat::Dot;
+    }
+    return WorkflowFormat::EdgeList;
+}
+
+/**
+ * Reads a workflow from a text file.
+ * @param path Path of the file
+ * @param format Format of the file
+ * @param graph Workflow receiving the jobs and communications
+ * @param options Read options
+ * @throws std::runtime_error if the file can't be read or is malformed
+ */
+inline void readWorkflow(const std::string& path, WorkflowFormat format, WorkflowGraph& graph,
+                         const WorkflowReadOptions& options = WorkflowReadOptions()) {
+    switch (format) {
+    case WorkflowFormat::Dot:
+        readDot(path, graph, options);
+        break;
+    case WorkflowFormat::Dax:
+        readDax(path, graph, options);
+        break;
+    case WorkflowFormat::WfCommons:
+        readWfCommons(path, graph, options);
+        break;
+    default:
+        readEdgeList(path, graph, options);
+    }
+}
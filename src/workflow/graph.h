@@ -1,140 +1,532 @@
+#pragma once
+
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
-#include <unordered_map>
+#include "arena.h"
+#include "csr.h"
+#include "hash.h"
+#include "strings.h"
 
 // Represents a job in the workflow
+// Its name is interned in the graph's string table under the same id.
 struct Job {
-    std::string name;       ///< Name of the job
     int executionTime;      ///< Time taken by the job for execution
+    JobId id;               ///< Dense id of the job, assigned in the order jobs are added
 
     /**
      * Constructor for the Job struct.
-     * @param _name Name of the job
      * @param _executionTime Time taken by the job for execution
+     * @param _id Dense id of the job
      */
-    Job(std::string _name, int _executionTime): name(_name), executionTime(_executionTime) {}
+    Job(int _executionTime, JobId _id): executionTime(_executionTime), id(_id) {}
 };
 
+typedef uint32_t CommunicationId;  ///< Index of a communication in the graph's communication store
+
 // Represents communication between two jobs
 struct Communication {
-    Job* fromJob;           ///< Source job of the communication
-    Job* toJob;             ///< Destination job of the communication
+    JobId fromJob;          ///< Id of the source job of the communication
+    JobId toJob;            ///< Id of the destination job of the communication
     int commTime;           ///< Time taken for communication between jobs
 
     /**
      * Constructor for the Communication struct.
-     * @param _fromJob Source job of the communication
-     * @param _toJob Destination job of the communication
+     * @param _fromJob Id of the source job of the communication
+     * @param _toJob Id of the destination job of the communication
      * @param _commTime Time taken for communication between jobs
      */
-    Communication(Job* _fromJob, Job* _toJob, int _commTime): fromJob(_fromJob), toJob(_toJob), commTime(_commTime) {}
+    Communication(JobId _fromJob, JobId _toJob, int _commTime): fromJob(_fromJob), toJob(_toJob), commTime(_commTime) {}
+};
+
+/**
+ * Non-owning view over the jobs at one end of a list of communications, usable in range-based for loops.
+ * Jobs are resolved while iterating, so nothing is allocated.
+ */
+class NeighborJobs {
+private:
+    Span<CommunicationId> comms;            ///< Indices of the communications
+    const Communication* communications;    ///< Communication store of the graph
+    Job* const* jobs;                       ///< Jobs of the graph indexed by id
+    JobId Communication::* endpoint;        ///< End of each communication holding the neighbouring job
+public:
+    // Forward iterator yielding the neighbouring Job of each communication
+    class Iterator {
+    private:
+        const NeighborJobs* view;
+        const CommunicationId* comm;
+    public:
+        Iterator(const NeighborJobs* _view, const CommunicationId* _comm): view(_view), comm(_comm) {}
+        Job* operator*() const { return view->jobs[view->communications[*comm].*(view->endpoint)]; }
+        Iterator& operator++() { comm++; return *this; }
+        bool operator!=(const Iterator& other) const { return comm != other.comm; }
+        bool operator==(const Iterator& other) const { return comm == other.comm; }
+    };
+
+    /**
+     * Constructor for NeighborJobs.
+     * @param _comms Indices of the communications
+     * @param _communications Communication store of the graph
+     * @param _jobs Jobs of the graph indexed by id
+     * @param _endpoint End of each communication holding the neighbouring job
+     */
+    NeighborJobs(Span<CommunicationId> _comms, const Communication* _communications, Job* const* _jobs, JobId Communication::* _endpoint):
+        comms(_comms), communications(_communications), jobs(_jobs), endpoint(_endpoint) {}
+
+    Iterator begin() const { return Iterator(this, comms.begin()); }
+    Iterator end() const { return Iterator(this, comms.end()); }
+    size_t size() const { return comms.size(); }
+    bool empty() const { return comms.empty(); }
 };
 
 // Represents a directed acyclic graph of jobs and their communications
+// It acts as a builder for the frozen CSRWorkflowGraph on which scheduling runs.
+// Communications are owned by a single contiguous store. The adjacency lists only hold indices into it and
+// are derived from the store with a counting sort when first needed, so adding a communication is a single append.
+// Jobs added or changed are tracked as dirty so that a schedule can be updated instead of computed again.
+// A content hash over job names, execution times and communications is kept up to date along with every change.
 class WorkflowGraph {
 private:
-    std::unordered_map<std::string, Job*> jobs;  ///< Map of job names to Job objects
-    std::unordered_map<Job*, std::vector<Communication*>> inCommunications;  ///< Map of jobs to their incoming communications
-    std::unordered_map<Job*, std::vector<Communication*>> outCommunications;  ///< Map of jobs to their outgoing communications
-public:
+    Arena arena;  ///< Owns all Job objects
+    StringTable jobNames;  ///< Interned job names, the id of a name is the id of its job
+    std::vector<Job*> jobsById;  ///< Job objects indexed by their dense id
+    std::vector<Communication> communications;  ///< Owning store of all communications
+    std::vector<uint32_t> inOffsets;   ///< Incoming communications of job v are inCommunications[inOffsets[v], inOffsets[v + 1])
+    std::vector<CommunicationId> inCommunications;   ///< Incoming communications grouped by destination job
+    std::vector<uint32_t> outOffsets;  ///< Outgoing communications of job v are outCommunications[outOffsets[v], outOffsets[v + 1])
+    std::vector<CommunicationId> outCommunications;  ///< Outgoing communications grouped by source job
+    bool isIndexed = false;        ///< Whether the adjacency lists reflect the current jobs and communications
+    CSRWorkflowGraph frozenGraph;  ///< CSR form of the graph, rebuilt lazily after mutation
+    bool isFrozen = false;         ///< Whether frozenGraph reflects the current jobs and communications once pendingEdits are applied
+    std::vector<CSREdit> pendingEdits;  ///< Communications added or removed since frozenGraph was last brought up to date
+    std::vector<JobId> dirtyJobs;  ///< Jobs added, or whose execution time or communications changed, since last cleared
+    std::vector<bool> isDirty;     ///< Whether a job is listed in dirtyJobs, indexed by job id
+    std::vector<uint64_t> nameHashes;  ///< Hash of the name of every job indexed by job id
+    GraphHash contentHash;         ///< Hash of the current jobs and communications, independent of their ids
+
     /**
-     * Destructor for WorkflowGraph class.
-     * Deletes dynamically allocated Job and Communication objects.
+     * Adds a job to the content hash, or removes it.
+     * @param job Id of the job
+     * @param sign 1 to add the job, -1 to remove it
      */
-    ~WorkflowGraph() {
-        for (auto& job : jobs) {
-            delete job.second;
+    void hashJob(JobId job, int sign) {
+        uint64_t values[] = {1, nameHashes[job], static_cast<uint32_t>(jobsById[job]->executionTime)};
+        contentHash.add(values, 3, sign);
+    }
+
+    /**
+     * Adds a communication to the content hash, or removes it.
+     * @param comm The communication
+     * @param sign 1 to add the communication, -1 to remove it
+     */
+    void hashCommunication(const Communication& comm, int sign) {
+        uint64_t values[] = {2, nameHashes[comm.fromJob], nameHashes[comm.toJob], static_cast<uint32_t>(comm.commTime)};
+        contentHash.add(values, 4, sign);
+    }
+
+    /**
+     * @param job Id of a job
+     * @throws std::out_of_range if there is no job with the id
+     */
+    void checkJobId(JobId job) const {
+        if (job >= jobsById.size()) {
+            throw std::out_of_range("Unknown job id: " + std::to_string(job));
         }
+    }
 
-        for (auto& cpair : inCommunications) {
-            for (auto& comm : cpair.second) {
-                delete comm;
-            }
+    /**
+     * Records that a job was added or changed.
+     * @param job Id of the job
+     */
+    void markDirty(JobId job) {
+        if (job >= isDirty.size()) {
+            isDirty.resize(jobsById.size(), false);
+        }
+        if (!isDirty[job]) {
+            isDirty[job] = true;
+            dirtyJobs.emplace_back(job);
         }
+    }
 
-        for (auto& cpair : outCommunications) {
-            for (auto& comm : cpair.second) {
-                delete comm;
-            }
+    /**
+     * Groups communication indices by one endpoint with a stable counting sort.
+     * @param endpoint Member of Communication used for grouping
+     * @param offsets Resulting offset array
+     * @param index Resulting communication indices
+     */
+    void buildAdjacency(JobId Communication::* endpoint, std::vector<uint32_t>& offsets, std::vector<CommunicationId>& index) const {
+        offsets.assign(jobsById.size() + 1, 0);
+        for (const auto& comm: communications) {
+            offsets[comm.*endpoint + 1]++;
+        }
+        for (size_t v = 0; v < jobsById.size(); v++) {
+            offsets[v + 1] += offsets[v];
+        }
+
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        index.resize(communications.size());
+        for (CommunicationId id = 0; id < communications.size(); id++) {
+            index[cursor[communications[id].*endpoint]++] = id;
+        }
+    }
+
+    /**
+     * Rebuilds the adjacency lists if jobs or communications were added since they were last built.
+     */
+    void ensureIndexed() {
+        if (!isIndexed) {
+            buildAdjacency(&Communication::toJob, inOffsets, inCommunications);
+            buildAdjacency(&Communication::fromJob, outOffsets, outCommunications);
+            isIndexed = true;
         }
     }
+public:
+    /**
+     * Preallocates storage for a graph of the given size so that building it causes no reallocation.
+     * @param numJobs Expected number of jobs
+     * @param numCommunications Expected number of communications
+     * @param numNameChars Expected total length of all job names
+     */
+    void reserve(size_t numJobs, size_t numCommunications, size_t numNameChars = 0) {
+        jobNames.reserve(numJobs, numNameChars);
+        jobsById.reserve(numJobs);
+        nameHashes.reserve(numJobs);
+        arena.reserve((numJobs - std::min(numJobs, jobsById.size())) * sizeof(Job));
+        communications.reserve(numCommunications);
+    }
 
     /**
      * Adds a new job to the workflow.
+     * Adding a job whose name already exists updates its execution time.
      * @param name Name of the job
      * @param executionTime Time taken by the job for execution
+     * @return Dense id of the job
+     */
+    JobId addJob(const std::string& name, int executionTime) {
+        isIndexed = false;
+        bool isNew;
+        JobId id = jobNames.intern(name.data(), name.size(), isNew);
+        if (!isNew) {
+            setExecutionTime(id, executionTime);
+            return id;
+        }
+
+        jobsById.emplace_back(arena.create<Job>(executionTime, id));
+        nameHashes.emplace_back(GraphHash::hashString(name.data(), name.size()));
+        hashJob(id, 1);
+        if (isFrozen) {
+            frozenGraph.addJob(executionTime);
+        }
+        markDirty(id);
+        return id;
+    }
+
+    /**
+     * Changes the execution time of a job.
+     * @param id Dense id of the job
+     * @param executionTime Time taken by the job for execution
      */
-    void addJob(std::string name, int executionTime) {
-        jobs[name] = new Job(name, executionTime);
-        inCommunications[jobs[name]] = std::vector<Communication*>();
-        outCommunications[jobs[name]] = std::vector<Communication*>();
+    void setExecutionTime(JobId id, int executionTime) {
+        if (jobsById[id]->executionTime == executionTime) {
+            return;
+        }
+        hashJob(id, -1);
+        jobsById[id]->executionTime = executionTime;
+        hashJob(id, 1);
+        if (isFrozen) {
+            frozenGraph.setExecutionTime(id, executionTime);
+        }
+        markDirty(id);
+    }
+
+    /**
+     * Adds many jobs at once.
+     * @param names Names of the jobs
+     * @param executionTimes Time taken by each job for execution
+     */
+    void addJobs(const std::vector<std::string>& names, const std::vector<int>& executionTimes) {
+        size_t numNameChars = 0;
+        for (const auto& name: names) {
+            numNameChars += name.size();
+        }
+        reserve(jobsById.size() + names.size(), communications.size(), numNameChars);
+        for (size_t i = 0; i < names.size(); i++) {
+            addJob(names[i], executionTimes[i]);
+        }
     }
 
     /**
      * Adds a communication link between two jobs.
+     * Both jobs must have been added before.
      * @param fromJobName Name of the source job
      * @param toJobName Name of the destination job
      * @param commTime Time taken for communication between jobs
      */
-    void addCommunication(std::string fromJobName, std::string toJobName, int commTime) {
-        Communication* newCommunication = new Communication(jobs[fromJobName], jobs[toJobName], commTime);
-        inCommunications[jobs[toJobName]].emplace_back(newCommunication);
-        outCommunications[jobs[fromJobName]].emplace_back(newCommunication);
+    void addCommunication(const std::string& fromJobName, const std::string& toJobName, int commTime) {
+        addCommunication(getJobId(fromJobName), getJobId(toJobName), commTime);
+    }
+
+    /**
+     * Adds a communication link between two jobs identified by their ids.
+     * @param fromJob Id of the source job
+     * @param toJob Id of the destination job
+     * @param commTime Time taken for communication between jobs
+     * @throws std::out_of_range if there is no job with either id
+     */
+    void addCommunication(JobId fromJob, JobId toJob, int commTime) {
+        checkJobId(fromJob);
+        checkJobId(toJob);
+        isIndexed = false;
+        communications.emplace_back(fromJob, toJob, commTime);
+        hashCommunication(communications.back(), 1);
+        if (isFrozen) {
+            pendingEdits.push_back({fromJob, toJob, commTime, false});
+        }
+        markDirty(fromJob);
+        markDirty(toJob);
+    }
+
+    /**
+     * Adds many communication links at once from an edge list given as parallel arrays.
+     * @param count Number of communications
+     * @param fromJobs Id of the source job of each communication
+     * @param toJobs Id of the destination job of each communication
+     * @param commTimes Time taken by each communication
+     * @throws std::out_of_range if there is no job with one of the ids, in which case no communication is added
+     */
+    void addCommunications(size_t count, const JobId* fromJobs, const JobId* toJobs, const int* commTimes) {
+        for (size_t i = 0; i < count; i++) {
+            checkJobId(fromJobs[i]);
+            checkJobId(toJobs[i]);
+        }
+        isFrozen = false;
+        pendingEdits.clear();
+        isIndexed = false;
+        communications.reserve(communications.size() + count);
+        for (size_t i = 0; i < count; i++) {
+            communications.emplace_back(fromJobs[i], toJobs[i], commTimes[i]);
+            hashCommunication(communications.back(), 1);
+            markDirty(fromJobs[i]);
+            markDirty(toJobs[i]);
+        }
+    }
+
+    /**
+     * Removes all communication links from one job to another.
+     * @param fromJobName Name of the source job
+     * @param toJobName Name of the destination job
+     * @return Number of communications removed
+     */
+    size_t removeCommunication(const std::string& fromJobName, const std::string& toJobName) {
+        return removeCommunication(getJobId(fromJobName), getJobId(toJobName));
+    }
+
+    /**
+     * Removes all communication links from one job to another identified by their ids.
+     * The other communications keep their order, but not their index in the communication store.
+     * @param fromJob Id of the source job
+     * @param toJob Id of the destination job
+     * @return Number of communications removed
+     */
+    size_t removeCommunication(JobId fromJob, JobId toJob) {
+        auto removed = std::remove_if(communications.begin(), communications.end(), [&](const Communication& comm) {
+            if (comm.fromJob != fromJob || comm.toJob != toJob) {
+                return false;
+            }
+            hashCommunication(comm, -1);
+            return true;
+        });
+        size_t numRemoved = communications.end() - removed;
+        if (numRemoved == 0) {
+            return 0;
+        }
+
+        communications.erase(removed, communications.end());
+        isIndexed = false;
+        if (isFrozen) {
+            pendingEdits.push_back({fromJob, toJob, 0, true});
+        }
+        markDirty(fromJob);
+        markDirty(toJob);
+        return numRemoved;
+    }
+
+    /**
+     * @return Number of jobs in the workflow
+     */
+    size_t getNumJobs() const {
+        return jobsById.size();
+    }
+
+    /**
+     * @return Number of communications in the workflow
+     */
+    size_t getNumCommunications() const {
+        return communications.size();
+    }
+
+    /**
+     * Looks up the id of a job by its name.
+     * @param name Name of the job
+     * @return Dense id of the job
+     * @throws std::out_of_range if there is no job with the name
+     */
+    JobId getJobId(const std::string& name) const {
+        JobId id;
+        if (!jobNames.find(name.data(), name.size(), id)) {
+            throw std::out_of_range("Unknown job: " + name);
+        }
+        return id;
+    }
+
+    /**
+     * Looks up the id of a job by its name, if there is one.
+     * @param name Name of the job
+     * @param id Set to the dense id of the job if there is one
+     * @return True if there is a job with the name, false otherwise
+     */
+    bool findJobId(const std::string& name, JobId& id) const {
+        return jobNames.find(name.data(), name.size(), id);
+    }
+
+    /**
+     * @param id Dense id of the job
+     * @return Name of the job, valid until the next job is added
+     */
+    const char* getJobName(JobId id) const {
+        return jobNames.get(id);
+    }
+
+    /**
+     * Retrieves a job by its dense id.
+     * @param id Dense id of the job
+     * @return Pointer to the Job object
+     */
+    Job* getJob(JobId id) const {
+        return jobsById[id];
+    }
+
+    /**
+     * Retrieves a communication by its index in the communication store.
+     * @param id Index of the communication
+     * @return Reference to the Communication object
+     */
+    const Communication& getCommunication(CommunicationId id) const {
+        return communications[id];
+    }
+
+    /**
+     * Content hash of the workflow over the names and execution times of its jobs and its communications, kept up to
+     * date with every change. It doesn't depend on the order in which jobs and communications were added, so workflows
+     * with the same content built in any order have the same hash.
+     * @return Hash of the workflow
+     */
+    const GraphHash& getContentHash() const {
+        return contentHash;
+    }
+
+    /**
+     * @return Jobs added, or whose execution time or communications changed, since the dirty jobs were last cleared
+     */
+    const std::vector<JobId>& getDirtyJobs() const {
+        return dirtyJobs;
+    }
+
+    /**
+     * Forgets about the changes made so far, once they are taken into account.
+     */
+    void clearDirtyJobs() {
+        for (JobId job: dirtyJobs) {
+            isDirty[job] = false;
+        }
+        dirtyJobs.clear();
+    }
+
+    /**
+     * Freezes the workflow into its CSR form, reusing the previous one if nothing changed since.
+     * Once frozen, jobs added or changed later are patched into the CSR form in place, and single communications added
+     * or removed are collected and merged into it by the next call in one O(V + E + P log P) pass for P edits, however
+     * many there are. Bulk additions build it again.
+     * @return CSR representation of the workflow, valid until the next mutation
+     */
+    const CSRWorkflowGraph& freeze() {
+        if (isFrozen) {
+            frozenGraph.applyEdits(pendingEdits);
+            pendingEdits.clear();
+            return frozenGraph;
+        }
+
+        std::vector<int> executionTimes;
+        executionTimes.reserve(jobsById.size());
+        for (const auto& job: jobsById) {
+            executionTimes.emplace_back(job->executionTime);
+        }
+
+        std::vector<JobId> fromJobs, toJobs;
+        std::vector<int> commTimes;
+        fromJobs.reserve(communications.size());
+        toJobs.reserve(communications.size());
+        commTimes.reserve(communications.size());
+        for (const auto& comm: communications) {
+            fromJobs.emplace_back(comm.fromJob);
+            toJobs.emplace_back(comm.toJob);
+            commTimes.emplace_back(comm.commTime);
+        }
+
+        frozenGraph = CSRWorkflowGraph(executionTimes.size(), executionTimes.data(),
+                                       commTimes.size(), fromJobs.data(), toJobs.data(), commTimes.data());
+        isFrozen = true;
+        return frozenGraph;
     }
 
     /**
      * Retrieves incoming communications for a given job.
      * @param job The job for which incoming communications are to be retrieved
-     * @return Vector of Communication representing incoming communications
+     * @return View of indices of the incoming communications, valid until the next mutation
      */
-    std::vector<Communication*>& getInCommunications(Job* job) {
-        return inCommunications[job];
+    Span<CommunicationId> getInCommunications(Job* job) {
+        ensureIndexed();
+        return Span<CommunicationId>(inCommunications.data() + inOffsets[job->id], inCommunications.data() + inOffsets[job->id + 1]);
     }
 
     /**
      * Retrieves outgoing communications for a given job.
      * @param job The job for which outgoing communications are to be retrieved
-     * @return Vector of Communication representing outgoing communications
+     * @return View of indices of the outgoing communications, valid until the next mutation
      */
-    std::vector<Communication*>& getOutCommunications(Job* job) {
-        return outCommunications[job];
+    Span<CommunicationId> getOutCommunications(Job* job) {
+        ensureIndexed();
+        return Span<CommunicationId>(outCommunications.data() + outOffsets[job->id], outCommunications.data() + outOffsets[job->id + 1]);
     }
 
     /**
      * Retrieves predecessors (jobs with incoming communications) for a given job.
      * @param job The job for which predecessors are to be retrieved
-     * @return Vector of Job representing predecessors
+     * @return View of Job representing predecessors, valid until the next mutation
      */
-    std::vector<Job*> getPredecessors(Job* job) {
-        std::vector<Job*> predJobs;
-        for (const auto& comms: getInCommunications(job)) {
-            predJobs.emplace_back(comms->fromJob);
-        }
-        return predJobs;
+    NeighborJobs getPredecessors(Job* job) {
+        return NeighborJobs(getInCommunications(job), communications.data(), jobsById.data(), &Communication::fromJob);
     }
 
     /**
      * Retrieves successors (jobs with outgoing communications) for a given job.
      * @param job The job for which successors are to be retrieved
-     * @return Vector of Job representing successors
+     * @return View of Job representing successors, valid until the next mutation
      */
-    std::vector<Job*> getSuccessors(Job* job) {
-        std::vector<Job*> succJobs;
-        for (const auto& comms: getOutCommunications(job)) {
-            succJobs.emplace_back(comms->toJob);
-        }
-        return succJobs;
+    NeighborJobs getSuccessors(Job* job) {
+        return NeighborJobs(getOutCommunications(job), communications.data(), jobsById.data(), &Communication::toJob);
     }
 
     /**
      * Calculates indegrees (number of incoming communications) for all jobs in the workflow.
-     * @return Map of Job to their respective indegrees
+     * @return Vector of indegrees indexed by job id
      */
-    std::unordered_map<Job*, int> getIndegrees() {
-        std::unordered_map<Job*, int> inDegrees;
-        for (const auto& cpair: inCommunications) {
-            inDegrees[cpair.first] = cpair.second.size();
+    std::vector<int> getIndegrees() const {
+        std::vector<int> inDegrees(jobsById.size(), 0);
+        for (const auto& comm: communications) {
+            inDegrees[comm.toJob]++;
         }
 
         return inDegrees;
@@ -144,10 +536,11 @@ public:
      * Prints the workflow, including job names, execution times, and communication details.
      */
     void printWorkflow() {
-        for (const auto& job : jobs) {
-            std::cout << "Job: " << job.first << " (Execution Time: " << job.second->executionTime << "):\n";
-            for (const auto& communication : outCommunications[job.second]) {
-                std::cout << "\t-> " << communication->toJob->name << " (Communication Time: " << communication->commTime << ")\n";
+        for (const auto& job : jobsById) {
+            std::cout << "Job: " << getJobName(job->id) << " (Execution Time: " << job->executionTime << "):\n";
+            for (const auto& comm : getOutCommunications(job)) {
+                const Communication& communication = communications[comm];
+                std::cout << "\t-> " << getJobName(communication.toJob) << " (Communication Time: " << communication.commTime << ")\n";
             }
             std::cout << std::endl;
         }
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 128-bit content hash of a workflow, as two independent 64-bit lanes.
+ * Every job and communication contributes the hash of its own content, and the contributions are summed, so the hash
+ * doesn't depend on the order in which they were added and an element can be removed by subtracting it again.
+ */
+struct GraphHash {
+    uint64_t low = 0;       ///< Sum of the first lane of every element
+    uint64_t high = 0;      ///< Sum of the second lane of every element
+
+    bool operator==(const GraphHash& other) const {
+        return low == other.low && high == other.high;
+    }
+
+    bool operator!=(const GraphHash& other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * Splitmix64 finalizer, spreading every input bit over all output bits.
+     * @param x Value to mix
+     * @return Mixed value
+     */
+    static uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    /**
+     * 64-bit FNV-1a hash of a string.
+     * @param str Characters of the string
+     * @param length Length of the string
+     * @return Hash of the string
+     */
+    static uint64_t hashString(const char* str, size_t length) {
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < length; i++) {
+            h = (h ^ static_cast<unsigned char>(str[i])) * 1099511628211ull;
+        }
+        return mix(h);
+    }
+
+    /**
+     * Adds an element, given as a sequence of values hashed in order, to the hash.
+     * @param values Values describing the element
+     * @param count Number of values
+     * @param sign 1 to add the element, -1 to remove it
+     */
+    void add(const uint64_t* values, size_t count, int sign = 1) {
+        uint64_t lane1 = 0x243F6A8885A308D3ull, lane2 = 0x13198A2E03707344ull;
+        for (size_t i = 0; i < count; i++) {
+            lane1 = mix(lane1 ^ values[i]);
+            lane2 = mix(lane2 + values[i] * 0xA4093822299F31D1ull);
+        }
+        low += sign > 0 ? lane1 : -lane1;
+        high += sign > 0 ? lane2 : -lane2;
+    }
+};
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Tournament tree over the finish times of the machines.
+ * Every inner node holds the earliest finish time among the machines below it, so updating a machine and
+ * finding the leftmost machine that is free by a given time both take O(log K) for K machines.
+ */
+class MachineTournamentTree {
+private:
+    size_t numLeaves;       ///< Number of leaves, the smallest power of two not less than the number of machines
+    std::vector<int> tree;  ///< Node i has children 2i and 2i + 1, leaf of machine m is numLeaves + m
+public:
+    /**
+     * Constructor for MachineTournamentTree, with every machine free from time zero.
+     * @param numMachines Number of machines
+     */
+    explicit MachineTournamentTree(int numMachines): numLeaves(1) {
+        while (numLeaves < static_cast<size_t>(numMachines)) {
+            numLeaves *= 2;
+        }
+        // padding leaves never win
+        tree.assign(2 * numLeaves, INT_MAX);
+        std::fill(tree.begin() + numLeaves, tree.begin() + numLeaves + numMachines, 0);
+        for (size_t node = numLeaves - 1; node > 0; node--) {
+            tree[node] = std::min(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+
+    /**
+     * @param machine ID of the machine
+     * @return Time at which the machine finishes its last scheduled job
+     */
+    int getFinishTime(int machine) const {
+        return tree[numLeaves + machine];
+    }
+
+    /**
+     * Updates the finish time of a machine.
+     * @param machine ID of the machine
+     * @param finishTime Time at which the machine finishes its last scheduled job
+     */
+    void setFinishTime(int machine, int finishTime) {
+        size_t node = numLeaves + machine;
+        tree[node] = finishTime;
+        for (node /= 2; node > 0; node /= 2) {
+            tree[node] = std::min(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+
+    /**
+     * @return Earliest finish time among all machines
+     */
+    int getEarliestFinishTime() const {
+        return tree[1];
+    }
+
+    /**
+     * Finds the machine with the smallest ID that finishes no later than the given time.
+     * @param time Time limit, at least the earliest finish time among all machines
+     * @return ID of the machine
+     */
+    int findFirstFreeBy(int time) const {
+        size_t node = 1;
+        while (node < numLeaves) {
+            node = tree[2 * node] <= time ? 2 * node : 2 * node + 1;
+        }
+        return node - numLeaves;
+    }
+};
+
+/**
+ * Idle gaps of every machine, for placing jobs into holes left between already scheduled jobs.
+ * Every gap is a node of two treaps at once: the treap of its machine and a treap of all gaps, both ordered by start
+ * time and then by machine. Every node also holds the longest gap and the latest gap end below it, so finding the
+ * earliest gap that fits a job, on one machine or on any machine, and splitting a gap around a placed job all take
+ * O(log G) expected for G gaps. Visiting the k gaps that can run a job right from a given time takes O((k + 1) log G)
+ * expected instead, where k is at most the number of machines since the gaps of a machine don't overlap, so a job
+ * ready while many machines are idle around its ready time costs up to O(K log G).
+ * Every machine is also idle from the finish time of its last job on, which is not a gap.
+ */
+class MachineTimelines {
+private:
+    enum : uint32_t { NIL = 0 };    ///< Index of the sentinel node standing for an empty subtree
+    enum { MACHINE_TREE = 0, GLOBAL_TREE = 1 };  ///< Treaps a node belongs to
+
+    // Represents an idle gap as a node of both treaps
+    struct Gap {
+        int start;          ///< Time when the machine becomes idle
+        int end;            ///< Time when the machine becomes busy again
+        int machine;        ///< ID of the machine
+        uint32_t priority;  ///< Random heap priority of the node
+        uint32_t left[2];   ///< Subtree of the earlier gaps in each treap
+        uint32_t right[2];  ///< Subtree of the later gaps in each treap
+        int maxLength[2];   ///< Longest gap in the subtree rooted at this node in each treap
+        int maxEnd[2];      ///< Latest gap end in the subtree rooted at this node in each treap
+    };
+
+    std::vector<Gap> nodes;         ///< Node pool, node 0 is the sentinel
+    std::vector<uint32_t> freeNodes;  ///< Nodes of removed gaps available for reuse
+    std::vector<uint32_t> roots;    ///< Root of the treap of every machine
+    uint32_t globalRoot = NIL;      ///< Root of the treap of all gaps
+    std::vector<int> finishTimes;   ///< Finish time of the last job of every machine
+    uint32_t seed = 2463534242u;    ///< State of the xorshift generator for node priorities
+
+    /**
+     * @return True if the gap comes before the given start time and machine
+     */
+    bool isBefore(uint32_t node, int start, int machine) const {
+        return nodes[node].start < start || (nodes[node].start == start && nodes[node].machine < machine);
+    }
+
+    /**
+     * Recomputes the longest gap and the latest gap end below a node from its children.
+     * @param node Index of the node
+     * @param tree Treap to update
+     */
+    void update(uint32_t node, int tree) {
+        Gap& gap = nodes[node];
+        const Gap& left = nodes[gap.left[tree]];
+        const Gap& right = nodes[gap.right[tree]];
+        gap.maxLength[tree] = std::max(gap.end - gap.start, std::max(left.maxLength[tree], right.maxLength[tree]));
+        gap.maxEnd[tree] = std::max(gap.end, std::max(left.maxEnd[tree], right.maxEnd[tree]));
+    }
+
+    /**
+     * Splits a treap into the gaps before a start time and machine and the rest.
+     * @param node Root of the treap
+     * @param tree Treap to split
+     * @param start Start time of the split point
+     * @param machine Machine of the split point
+     * @param left Receives the root of the earlier gaps
+     * @param right Receives the root of the other gaps
+     */
+    void split(uint32_t node, int tree, int start, int machine, uint32_t& left, uint32_t& right) {
+        if (node == NIL) {
+            left = right = NIL;
+        } else if (isBefore(node, start, machine)) {
+            split(nodes[node].right[tree], tree, start, machine, nodes[node].right[tree], right);
+            left = node;
+            update(node, tree);
+        } else {
+            split(nodes[node].left[tree], tree, start, machine, left, nodes[node].left[tree]);
+            right = node;
+            update(node, tree);
+        }
+    }
+
+    /**
+     * Joins two treaps where every gap of the first one comes before any gap of the second one.
+     * @param left Root of the earlier gaps
+     * @param right Root of the later gaps
+     * @param tree Treap to join
+     * @return Root of the joined treap
+     */
+    uint32_t merge(uint32_t left, uint32_t right, int tree) {
+        if (left == NIL || right == NIL) {
+            return left == NIL ? right : left;
+        }
+        if (nodes[left].priority > nodes[right].priority) {
+            nodes[left].right[tree] = merge(nodes[left].right[tree], right, tree);
+            update(left, tree);
+            return left;
+        }
+        nodes[right].left[tree] = merge(left, nodes[right].left[tree], tree);
+        update(right, tree);
+        return right;
+    }
+
+    /**
+     * Creates a gap and adds it to both treaps.
+     * @param machine ID of the machine
+     * @param start Time when the machine becomes idle
+     * @param end Time when the machine becomes busy again
+     */
+    void addGap(int machine, int start, int end) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        Gap gap = {start, end, machine, seed, {NIL, NIL}, {NIL, NIL}, {end - start, end - start}, {end, end}};
+        uint32_t node;
+        if (!freeNodes.empty()) {
+            node = freeNodes.back();
+            freeNodes.pop_back();
+            nodes[node] = gap;
+        } else {
+            node = nodes.size();
+            nodes.emplace_back(gap);
+        }
+
+        uint32_t* treeRoots[2] = {&roots[machine], &globalRoot};
+        for (int tree = MACHINE_TREE; tree <= GLOBAL_TREE; tree++) {
+            uint32_t left, right;
+            split(*treeRoots[tree], tree, start, machine, left, right);
+            *treeRoots[tree] = merge(merge(left, node, tree), right, tree);
+        }
+    }
+
+    /**
+     * Removes a gap from both treaps.
+     * @param node Index of the gap
+     */
+    void removeGap(uint32_t node) {
+        int start = nodes[node].start, machine = nodes[node].machine;
+        uint32_t* treeRoots[2] = {&roots[machine], &globalRoot};
+        for (int tree = MACHINE_TREE; tree <= GLOBAL_TREE; tree++) {
+            uint32_t left, middle, right;
+            split(*treeRoots[tree], tree, start, machine, left, middle);
+            split(middle, tree, start, machine + 1, middle, right);
+            *treeRoots[tree] = merge(left, right, tree);
+        }
+        freeNodes.emplace_back(node);
+    }
+
+    /**
+     * Finds the last gap of a machine starting no later than a time.
+     * @param machine ID of the machine
+     * @param time Time limit
+     * @return Index of the gap, NIL if there is none
+     */
+    uint32_t findLastStartingBy(int machine, int time) const {
+        uint32_t found = NIL;
+        for (uint32_t node = roots[machine]; node != NIL;) {
+            if (nodes[node].start <= time) {
+                found = node;
+                node = nodes[node].right[MACHINE_TREE];
+            } else {
+                node = nodes[node].left[MACHINE_TREE];
+            }
+        }
+        return found;
+    }
+
+    /**
+     * Finds the first gap in a treap starting after a time that is at least as long as required.
+     * Subtrees without a long enough gap are skipped, so only O(log G) nodes are visited.
+     * @param node Root of the subtree
+     * @param tree Treap to search
+     * @param time Time after which the gap must start
+     * @param length Required length
+     * @return Index of the gap, NIL if there is none
+     */
+    uint32_t findFirstFitAfter(uint32_t node, int tree, int time, int length) const {
+        if (node == NIL || nodes[node].maxLength[tree] < length) {
+            return NIL;
+        }
+        const Gap& gap = nodes[node];
+        if (gap.start <= time) {
+            return findFirstFitAfter(gap.right[tree], tree, time, length);
+        }
+        uint32_t found = findFirstFitAfter(gap.left[tree], tree, time, length);
+        if (found != NIL) {
+            return found;
+        }
+        if (gap.end - gap.start >= length) {
+            return node;
+        }
+        return findFirstFitAfter(gap.right[tree], tree, time, length);
+    }
+
+    /**
+     * Visits every gap of all machines that starts no later than a time and ends no earlier than another one.
+     * Subtrees ending too early are skipped, so apart from the O(log G) nodes along the search path for the time, every
+     * node entered has a gap to visit below it, and visiting k gaps takes O((k + 1) log G) expected. Since the treap is
+     * ordered by start time rather than by end, there is no bound independent of k.
+     * @param node Root of the subtree of the treap of all gaps
+     * @param time Latest start time
+     * @param endTime Earliest end time
+     * @param visit Called with the ID of the machine of every such gap
+     */
+    template <class Visit>
+    void visitGapsSpanning(uint32_t node, int time, int endTime, const Visit& visit) const {
+        if (node == NIL || nodes[node].maxEnd[GLOBAL_TREE] < endTime) {
+            return;
+        }
+        const Gap& gap = nodes[node];
+        visitGapsSpanning(gap.left[GLOBAL_TREE], time, endTime, visit);
+        if (gap.start <= time) {
+            if (gap.end >= endTime) {
+                visit(gap.machine);
+            }
+            visitGapsSpanning(gap.right[GLOBAL_TREE], time, endTime, visit);
+        }
+    }
+public:
+    /**
+     * Constructor for MachineTimelines, with every machine idle from time zero.
+     * @param numMachines Number of machines
+     */
+    explicit MachineTimelines(int numMachines): roots(numMachines, NIL), finishTimes(numMachines, 0) {
+        // the sentinel never fits, not even a job of zero length
+        nodes.push_back({0, 0, -1, 0, {NIL, NIL}, {NIL, NIL}, {-1, -1}, {-1, -1}});
+    }
+
+    /**
+     * Finds the earliest time from which a machine stays idle long enough to run a job.
+     * A job of zero length also needs the machine to be idle, which includes the end of a gap.
+     * @param machine ID of the machine
+     * @param readyTime Earliest time the job may start
+     * @param duration Execution time of the job
+     * @return Earliest start time of the job on the machine
+     */
+    int findEarliestStart(int machine, int readyTime, int duration) const {
+        if (readyTime < finishTimes[machine]) {
+            uint32_t gap = findLastStartingBy(machine, readyTime);
+            if (gap != NIL && nodes[gap].end - readyTime >= duration) {
+                return readyTime;
+            }
+            gap = findFirstFitAfter(roots[machine], MACHINE_TREE, readyTime, duration);
+            if (gap != NIL) {
+                return nodes[gap].start;
+            }
+        }
+        return std::max(readyTime, finishTimes[machine]);
+    }
+
+    /**
+     * Visits every machine having a gap that can run a job right from a given time, in O((k + 1) log G) expected for
+     * the k machines visited.
+     * @param readyTime Earliest time the job may start
+     * @param duration Execution time of the job
+     * @param visit Called with the ID of every such machine
+     */
+    template <class Visit>
+    void forEachGapFrom(int readyTime, int duration, const Visit& visit) const {
+        visitGapsSpanning(globalRoot, readyTime, readyTime + duration, visit);
+    }
+
+    /**
+     * Finds the earliest gap on any machine starting after a time that is long enough to run a job.
+     * Among gaps starting at the same time, the one of the machine with the smallest ID is found.
+     * @param readyTime Time after which the gap must start
+     * @param duration Execution time of the job
+     * @param machine Receives the ID of the machine of the gap
+     * @param startTime Receives the start time of the gap
+     * @return True if there is such a gap, false otherwise
+     */
+    bool findFirstGapAfter(int readyTime, int duration, int& machine, int& startTime) const {
+        uint32_t gap = findFirstFitAfter(globalRoot, GLOBAL_TREE, readyTime, duration);
+        if (gap == NIL) {
+            return false;
+        }
+        machine = nodes[gap].machine;
+        startTime = nodes[gap].start;
+        return true;
+    }
+
+    /**
+     * Marks a machine busy while running a job, which must fit into one of its gaps or start after its last job.
+     * @param machine ID of the machine
+     * @param startTime Start time of the job
+     * @param finishTime Finish time of the job
+     */
+    void occupy(int machine, int startTime, int finishTime) {
+        if (startTime == finishTime) {
+            return;
+        }
+
+        if (startTime >= finishTimes[machine]) {
+            // the job runs after the last one, possibly leaving a new gap before it
+            if (startTime > finishTimes[machine]) {
+                addGap(machine, finishTimes[machine], startTime);
+            }
+            finishTimes[machine] = finishTime;
+            return;
+        }
+
+        // replace the gap holding the job by what remains of it on both sides of the job
+        uint32_t gap = findLastStartingBy(machine, startTime);
+        int gapStart = nodes[gap].start, gapEnd = nodes[gap].end;
+        removeGap(gap);
+        if (gapStart < startTime) {
+            addGap(machine, gapStart, startTime);
+        }
+        if (finishTime < gapEnd) {
+            addGap(machine, finishTime, gapEnd);
+        }
+    }
+};
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "csr.h"
+#include "graph.h"
+
+static_assert(sizeof(CSREdge) == 8, "CSREdge is stored as is in workflow files");
+
+/**
+ * Header of a binary workflow file. The file is a header followed by sections, each starting at an offset aligned to
+ * 8 bytes, holding the arrays of the CSR form and the job names exactly as they are used in memory, in native byte
+ * order. So a mapped file is used in place, without parsing or copying anything.
+ */
+struct WorkflowFileHeader {
+    enum : uint32_t {
+        MAGIC = 0x31474657u,    ///< "WFG1" in little endian
+        VERSION = 1
+    };
+
+    uint32_t magic;             ///< MAGIC
+    uint32_t version;           ///< VERSION
+    uint64_t numJobs;           ///< Number of jobs
+    uint64_t numEdges;          ///< Number of communications
+    uint64_t numNameChars;      ///< Size of the names section, including a null terminator after every name
+    uint64_t executionTimes;    ///< Offset of the execution time of each job, int32[numJobs]
+    uint64_t outOffsets;        ///< Offset of the outgoing edge offsets, uint32[numJobs + 1]
+    uint64_t outEdges;          ///< Offset of the outgoing edges grouped by source job, CSREdge[numEdges]
+    uint64_t inOffsets;         ///< Offset of the incoming edge offsets, uint32[numJobs + 1]
+    uint64_t inEdges;           ///< Offset of the incoming edges grouped by destination job, CSREdge[numEdges]
+    uint64_t nameOffsets;       ///< Offset of the start of each name in the names section, uint32[numJobs]
+    uint64_t names;             ///< Offset of the null-terminated job names, char[numNameChars]
+    uint64_t fileSize;          ///< Size of the whole file
+};
+
+/**
+ * Writes a workflow in the binary format read by MappedWorkflow.
+ * @param path Path of the file
+ * @param graph Frozen workflow
+ * @param jobNames Name of every job indexed by job id
+ * @throws std::runtime_error if the file can't be written
+ */
+inline void writeWorkflowFile(const std::string& path, const CSRWorkflowGraph& graph, const std::vector<const char*>& jobNames) {
+    size_t numJobs = graph.getNumJobs(), numEdges = graph.getNumCommunications();
+    auto align = [](uint64_t offset) { return (offset + 7) & ~uint64_t(7); };
+
+    std::vector<uint32_t> nameOffsets(numJobs);
+    uint64_t numNameChars = 0;
+    for (JobId job = 0; job < numJobs; job++) {
+        nameOffsets[job] = numNameChars;
+        numNameChars += std::strlen(jobNames[job]) + 1;
+    }
+
+    WorkflowFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = WorkflowFileHeader::MAGIC;
+    header.version = WorkflowFileHeader::VERSION;
+    header.numJobs = numJobs;
+    header.numEdges = numEdges;
+    header.numNameChars = numNameChars;
+    header.executionTimes = align(sizeof(header));
+    header.outOffsets = align(header.executionTimes + numJobs * sizeof(int32_t));
+    header.outEdges = align(header.outOffsets + (numJobs + 1) * sizeof(uint32_t));
+    header.inOffsets = align(header.outEdges + numEdges * sizeof(CSREdge));
+    header.inEdges = align(header.inOffsets + (numJobs + 1) * sizeof(uint32_t));
+    header.nameOffsets = align(header.inEdges + numEdges * sizeof(CSREdge));
+    header.names = align(header.nameOffsets + numJobs * sizeof(uint32_t));
+    header.fileSize = header.names + numNameChars;
+
+    // the arrays of the CSR form are scattered per job, so they are gathered section by section
+    std::vector<int32_t> executionTimes(numJobs);
+    std::vector<uint32_t> outOffsets(numJobs + 1, 0), inOffsets(numJobs + 1, 0);
+    std::vector<CSREdge> outEdges, inEdges;
+    outEdges.reserve(numEdges);
+    inEdges.reserve(numEdges);
+    for (JobId job = 0; job < numJobs; job++) {
+        executionTimes[job] = graph.getExecutionTime(job);
+        outEdges.insert(outEdges.end(), graph.getOutEdges(job).begin(), graph.getOutEdges(job).end());
+        inEdges.insert(inEdges.end(), graph.getInEdges(job).begin(), graph.getInEdges(job).end());
+        outOffsets[job + 1] = outEdges.size();
+        inOffsets[job + 1] = inEdges.size();
+    }
+
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "wb"), std::fclose);
+    if (file == nullptr) {
+        throw std::runtime_error("Cannot open workflow file for writing: " + path);
+    }
+    uint64_t position = 0;
+    auto writeSection = [&](uint64_t offset, const void* data, size_t size) {
+        static const char padding[8] = {};
+        bool isWritten = std::fwrite(padding, 1, offset - position, file.get()) == offset - position &&
+                         (size == 0 || std::fwrite(data, 1, size, file.get()) == size);
+        if (!isWritten) {
+            throw std::runtime_error("Cannot write workflow file: " + path);
+        }
+        position = offset + size;
+    };
+    writeSection(0, &header, sizeof(header));
+    writeSection(header.executionTimes, executionTimes.data(), numJobs * sizeof(int32_t));
+    writeSection(header.outOffsets, outOffsets.data(), (numJobs + 1) * sizeof(uint32_t));
+    writeSection(header.outEdges, outEdges.data(), numEdges * sizeof(CSREdge));
+    writeSection(header.inOffsets, inOffsets.data(), (numJobs + 1) * sizeof(uint32_t));
+    writeSection(header.inEdges, inEdges.data(), numEdges * sizeof(CSREdge));
+    writeSection(header.nameOffsets, nameOffsets.data(), numJobs * sizeof(uint32_t));
+    writeSection(header.names, nullptr, 0);
+    for (JobId job = 0; job < numJobs; job++) {
+        writeSection(position, jobNames[job], std::strlen(jobNames[job]) + 1);
+    }
+}
+
+/**
+ * Writes a workflow in the binary format read by MappedWorkflow.
+ * @param path Path of the file
+ * @param graph The workflow
+ * @throws std::runtime_error if the file can't be written
+ */
+inline void writeWorkflowFile(const std::string& path, WorkflowGraph& graph) {
+    std::vector<const char*> jobNames(graph.getNumJobs());
+    for (JobId job = 0; job < jobNames.size(); job++) {
+        jobNames[job] = graph.getJobName(job);
+    }
+    writeWorkflowFile(path, graph.freeze(), jobNames);
+}
+
+/**
+ * Read-only memory mapping of a whole file, unmapped when destroyed.
+ */
+class MappedFile {
+private:
+    void* data = MAP_FAILED;    ///< Start of the mapping
+    size_t size = 0;            ///< Size of the mapping
+public:
+    /**
+     * Maps a file.
+     * @param path Path of the file
+     * @throws std::runtime_error if the file can't be opened or mapped
+     */
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if (fd < 0 || ::fstat(fd, &status) != 0) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw std::runtime_error("Cannot open workflow file: " + path);
+        }
+        size = status.st_size;
+        if (size > 0) {
+            data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map workflow file: " + path);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (data != MAP_FAILED) {
+            ::munmap(data, size);
+        }
+    }
+
+    /**
+     * @return Start of the mapped file
+     */
+    const char* getData() const {
+        return static_cast<const char*>(data);
+    }
+
+    /**
+     * @return Size of the mapped file
+     */
+    size_t getSize() const {
+        return size;
+    }
+};
+
+/**
+ * Workflow used in place from a memory-mapped binary workflow file written by writeWorkflowFile().
+ * Loading checks the header and makes one pass over the arrays, so that a corrupt file is rejected rather than
+ * read out of bounds, but parses and copies nothing. The frozen graph can be scheduled directly with WorkflowSchedule, and
+ * stays valid after the MappedWorkflow is destroyed, since it keeps the mapping alive.
+ */
+class MappedWorkflow {
+private:
+    std::shared_ptr<MappedFile> file;   ///< The mapped file
+    CSRWorkflowGraph graph;             ///< Frozen graph over the arrays of the file
+    const uint32_t* nameOffsets;        ///< Start of each name in names
+    const char* names;                  ///< Null-terminated job names
+
+    /**
+     * Checks, in one pass over the arrays of a file whose sections fit in it, that scheduling and naming its jobs
+     * stays within the file: offsets never decrease and end at the number of edges, edges lead to existing jobs, the
+     * incoming edges of every job come from the jobs whose outgoing edges lead to it, so that no job is placed before
+     * a predecessor, times aren't negative and every name starts in the names section, which ends with a null
+     * terminator.
+     * @return True if the arrays are consistent, false if the file is corrupt
+     */
+    static bool isValid(const WorkflowFileHeader& header, const int32_t* executionTimes,
+                        const uint32_t* outOffsets, const CSREdge* outEdges,
+                        const uint32_t* inOffsets, const CSREdge* inEdges,
+                        const uint32_t* nameOffsets, const char* names) {
+        uint64_t numJobs = header.numJobs, numEdges = header.numEdges;
+        auto isValidCSR = [&](const uint32_t* offsets, const CSREdge* edges) {
+            if (offsets[0] != 0 || offsets[numJobs] != numEdges) {
+                return false;
+            }
+            for (uint64_t job = 0; job < numJobs; job++) {
+                if (offsets[job] > offsets[job + 1]) {
+                    return false;
+                }
+            }
+            for (uint64_t edge = 0; edge < numEdges; edge++) {
+                if (edges[edge].job >= numJobs || edges[edge].commTime < 0) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        if (!isValidCSR(outOffsets, outEdges) || !isValidCSR(inOffsets, inEdges)) {
+            return false;
+        }
+
+        // sources of the outgoing edges grouped by destination, in the layout of the incoming edges
+        std::vector<uint32_t> fill(inOffsets, inOffsets + numJobs);
+        std::vector<JobId> sources(numEdges);
+        for (uint64_t job = 0; job < numJobs; job++) {
+            for (uint32_t edge = outOffsets[job]; edge < outOffsets[job + 1]; edge++) {
+                JobId toJob = outEdges[edge].job;
+                if (fill[toJob] == inOffsets[toJob + 1]) {
+                    return false;
+                }
+                sources[fill[toJob]++] = job;
+            }
+        }
+        std::vector<int64_t> balance(numJobs, 0);
+        for (uint64_t job = 0; job < numJobs; job++) {
+            for (uint32_t edge = inOffsets[job]; edge < inOffsets[job + 1]; edge++) {
+                balance[sources[edge]]++;
+                balance[inEdges[edge].job]--;
+            }
+            for (uint32_t edge = inOffsets[job]; edge < inOffsets[job + 1]; edge++) {
+                if (balance[inEdges[edge].job] != 0) {
+                    return false;
+                }
+            }
+        }
+        if (numJobs > 0 && (header.numNameChars == 0 || names[header.numNameChars - 1] != '\0')) {
+            return false;
+        }
+        for (uint64_t job = 0; job < numJobs; job++) {
+            if (executionTimes[job] < 0 || nameOffsets[job] >= header.numNameChars) {
+                return false;
+            }
+        }
+        return true;
+    }
+public:
+    /**
+     * Maps a workflow file.
+     * @param path Path of the file
+     * @throws std::runtime_error if the file can't be mapped or isn't a valid workflow file
+     */
+    explicit MappedWorkflow(const std::string& path): file(std::make_shared<MappedFile>(path)) {
+        const char* data = file->getData();
+        WorkflowFileHeader header;
+        if (file->getSize() < sizeof(header)) {
+            throw std::runtime_error("Not a workflow file: " + path);
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != WorkflowFileHeader::MAGIC || header.version != WorkflowFileHeader::VERSION) {
+            throw std::runtime_error("Not a workflow file: " + path);
+        }
+        uint64_t fileSize = file->getSize();
+        auto fits = [&](uint64_t offset, uint64_t count, uint64_t size) {
+            return offset % 8 == 0 && offset <= fileSize && count <= (fileSize - offset) / size;
+        };
+        bool isComplete = header.fileSize == fileSize && header.numJobs < fileSize &&
+                          fits(header.executionTimes, header.numJobs, sizeof(int32_t)) &&
+                          fits(header.outOffsets, header.numJobs + 1, sizeof(uint32_t)) &&
+                          fits(header.outEdges, header.numEdges, sizeof(CSREdge)) &&
+                          fits(header.inOffsets, header.numJobs + 1, sizeof(uint32_t)) &&
+                          fits(header.inEdges, header.numEdges, sizeof(CSREdge)) &&
+                          fits(header.nameOffsets, header.numJobs, sizeof(uint32_t)) &&
+                          fits(header.names, header.numNameChars, 1);
+        if (!isComplete) {
+            throw std::runtime_error("Truncated workflow file: " + path);
+        }
+
+        const uint32_t* outOffsets = reinterpret_cast<const uint32_t*>(data + header.outOffsets);
+        const uint32_t* inOffsets = reinterpret_cast<const uint32_t*>(data + header.inOffsets);
+        const CSREdge* outEdges = reinterpret_cast<const CSREdge*>(data + header.outEdges);
+        const CSREdge* inEdges = reinterpret_cast<const CSREdge*>(data + header.inEdges);
+        const int32_t* executionTimes = reinterpret_cast<const int32_t*>(data + header.executionTimes);
+        const uint32_t* fileNameOffsets = reinterpret_cast<const uint32_t*>(data + header.nameOffsets);
+        const char* fileNames = data + header.names;
+        if (!isValid(header, executionTimes, outOffsets, outEdges, inOffsets, inEdges, fileNameOffsets, fileNames)) {
+            throw std::runtime_error("Corrupt workflow file: " + path);
+        }
+        graph = CSRWorkflowGraph(header.numJobs, header.numEdges, executionTimes, outOffsets, outEdges, inOffsets, inEdges, file);
+        nameOffsets = fileNameOffsets;
+        names = fileNames;
+    }
+
+    /**
+     * @return Frozen graph over the arrays of the file
+     */
+    const CSRWorkflowGraph& getGraph() const {
+        return graph;
+    }
+
+    /**
+     * @return Number of jobs in the workflow
+     */
+    size_t getNumJobs() const {
+        return graph.getNumJobs();
+    }
+
+    /**
+     * @param id Dense id of the job
+     * @return Name of the job
+     */
+    const char* getJobName(JobId id) const {
+        return names + nameOffsets[id];
+    }
+};
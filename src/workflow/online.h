@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "placement.h"
+
+/**
+ * Schedules jobs as they arrive, each one on the machine where it finishes earliest given the jobs placed so far.
+ * Jobs get dense ids in the order they are submitted and may only depend on jobs submitted before. Placed jobs are
+ * committed and never moved, so a submission only costs placing one job: O(indegree + logK) with appending, and
+ * O(indegree + (indegree + c) * logG) with insertion for c idle gaps holding the job from its data arrival.
+ */
+class OnlineScheduler {
+private:
+    JobPlacer placer;       ///< Machines as left by the jobs placed so far
+    ScheduleState state;    ///< Placement of every job submitted so far
+    size_t numJobs = 0;     ///< Number of jobs submitted so far
+public:
+    /**
+     * Constructor for OnlineScheduler with every machine free from time zero.
+     * @param numMachines Number of machines available for scheduling
+     * @param policy How the start time of a job on a machine is chosen
+     */
+    OnlineScheduler(int numMachines, PlacementPolicy policy = PlacementPolicy::Append): placer(numMachines, policy) {}
+
+    /**
+     * Constructor for OnlineScheduler continuing after a schedule, such as the one given by WorkflowSchedule::schedule().
+     * The jobs of the schedule are committed as they are, and the next submitted job gets the id after theirs.
+     * @param scheduleOrder Scheduled jobs with dense ids, in an order where predecessors come first
+     * @param numMachines Number of machines available for scheduling
+     * @param policy How the start time of a job on a machine is chosen
+     */
+    OnlineScheduler(const ScheduleOrder& scheduleOrder, int numMachines, PlacementPolicy policy = PlacementPolicy::Append):
+        placer(numMachines, policy), state(scheduleOrder.size()), numJobs(scheduleOrder.size()) {
+        for (const ScheduledJob& scheduledJob: scheduleOrder) {
+            Placement placement = {scheduledJob.machineId, scheduledJob.startTime};
+            placer.place(scheduledJob.jobId, placement, scheduledJob.finishTime - scheduledJob.startTime, state);
+        }
+    }
+
+    /**
+     * Preallocates the placement of the jobs to be submitted so that submitting them causes no reallocation.
+     * @param totalJobs Expected total number of jobs, including those submitted so far
+     */
+    void reserve(size_t totalJobs) {
+        state.startTime.reserve(totalJobs);
+        state.finishTime.reserve(totalJobs);
+        state.machine.reserve(totalJobs);
+    }
+
+    /**
+     * Submits a job and places it right away.
+     * @param executionTime Time taken by the job for execution
+     * @param dependencies Jobs submitted before whose output is transferred to the job, with the communication time
+     * @return Scheduling information of the job, whose id is the number of jobs submitted before
+     * @throws std::out_of_range if a dependency has not been submitted yet
+     */
+    ScheduledJob submit(int executionTime, Span<CSREdge> dependencies) {
+        for (const CSREdge& dependency: dependencies) {
+            if (dependency.job >= numJobs) {
+                throw std::out_of_range("Dependency on a job not submitted yet: " + std::to_string(dependency.job));
+            }
+        }
+
+        JobId job = numJobs++;
+        state.resize(numJobs);
+        return placer.place(job, dependencies, executionTime, state);
+    }
+
+    /**
+     * Submits a job and places it right away.
+     * @param executionTime Time taken by the job for execution
+     * @param dependencies Jobs submitted before whose output is transferred to the job, with the communication time
+     * @return Scheduling information of the job, whose id is the number of jobs submitted before
+     * @throws std::out_of_range if a dependency has not been submitted yet
+     */
+    ScheduledJob submit(int executionTime, const std::vector<CSREdge>& dependencies) {
+        return submit(executionTime, Span<CSREdge>(dependencies.data(), dependencies.data() + dependencies.size()));
+    }
+
+    /**
+     * @return Number of jobs submitted so far
+     */
+    size_t getNumJobs() const {
+        return numJobs;
+    }
+
+    /**
+     * @return Placement of every job submitted so far indexed by job id
+     */
+    const ScheduleState& getState() const {
+        return state;
+    }
+
+    /**
+     * @param machine ID of the machine
+     * @return Time at which the machine finishes its last placed job
+     */
+    int getFinishTime(int machine) const {
+        return placer.getFinishTime(machine);
+    }
+
+    /**
+     * @return Time at which all machines finish all placed jobs
+     */
+    int getMakespan() const {
+        return placer.getMakespan();
+    }
+};
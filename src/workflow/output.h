@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "csr.h"
+#include "placement.h"
+
+// Formats a schedule can be written in.
+enum class ScheduleFormat {
+    Text,           ///< One readable sentence per job, followed by the makespan
+    Csv,            ///< Header "job,machine,schedule_time,start_time,finish_time" and one row per job
+    Json,           ///< Object {"jobs":[...],"makespan":N} with one object per job
+    ChromeTrace,    ///< Chrome trace event JSON, one complete event per job on the track of its machine
+    Binary          ///< Fixed-size records in native byte order, see BinaryScheduleWriter
+};
+
+// Gives the name of a job written in a schedule, or null to write its id instead.
+typedef std::function<const char*(JobId)> JobNameFunction;
+
+/**
+ * Output file or standard output written through a large buffer, with formatting of integers and strings that
+ * doesn't go through streams or locales. Nothing is flushed until the buffer is full, flush() is called or the
+ * output is destroyed.
+ */
+class BufferedOutput {
+private:
+    std::unique_ptr<FILE, int (*)(FILE*)> ownedFile;    ///< The file if it was opened here, null for standard output
+    FILE* file;                 ///< The file written
+    std::string path;           ///< Path of the file, for error messages
+    std::vector<char> buffer;   ///< Characters not yet written
+    size_t size = 0;            ///< Number of characters in the buffer
+public:
+    /**
+     * Opens an output.
+     * @param _path Path of the file, or empty or "-" for standard output
+     * @param bufferSize Number of characters written at once
+     * @throws std::runtime_error if the file can't be opened
+     */
+    explicit BufferedOutput(const std::string& _path = "", size_t bufferSize = 1 << 20):
+        ownedFile(nullptr, std::fclose), file(stdout), path(_path.empty() ? "-" : _path), buffer(bufferSize) {
+        if (path != "-") {
+            ownedFile.reset(std::fopen(path.c_str(), "wb"));
+            if (ownedFile == nullptr) {
+                throw std::runtime_error("Cannot open schedule file for writing: " + path);
+            }
+            file = ownedFile.get();
+        }
+    }
+
+    BufferedOutput(const BufferedOutput&) = delete;
+    BufferedOutput& operator=(const BufferedOutput&) = delete;
+
+    ~BufferedOutput() {
+        try {
+            flush();
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    /**
+     * Writes the buffered characters to the file.
+     * @throws std::runtime_error if the file can't be written
+     */
+    void flush() {
+        if (size > 0 && std::fwrite(buffer.data(), 1, size, file) != size) {
+            size = 0;
+            throw std::runtime_error("Cannot write schedule file: " + path);
+        }
+        size = 0;
+        if (std::fflush(file) != 0) {
+            throw std::runtime_error("Cannot write schedule file: " + path);
+        }
+    }
+
+    /**
+     * Writes bytes.
+     * @param data The bytes
+     * @param count Number of bytes
+     */
+    void write(const void* data, size_t count) {
+        if (size + count > buffer.size()) {
+            flush();
+            if (count > buffer.size()) {
+                if (std::fwrite(data, 1, count, file) != count) {
+                    throw std::runtime_error("Cannot write schedule file: " + path);
+                }
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + size, data, count);
+        size += count;
+    }
+
+    /**
+     * Writes a character.
+     * @param c The character
+     */
+    void put(char c) {
+        if (size == buffer.size()) {
+            flush();
+        }
+        buffer[size++] = c;
+    }
+
+    /**
+     * Writes a null-terminated string as is.
+     * @param str The string
+     */
+    void writeString(const char* str) {
+        write(str, std::strlen(str));
+    }
+
+    /**
+     * Writes an integer in decimal.
+     * @param value The integer
+     */
+    void writeInt(int64_t value) {
+        char digits[24];
+        char* last = digits + sizeof(digits);
+        char* first = last;
+        uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        do {
+            *--first = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (value < 0) {
+            *--first = '-';
+        }
+        write(first, last - first);
+    }
+
+    /**
+     * Writes a string as a quoted JSON string, escaping quotes, backslashes and control characters.
+     * @param str The string
+     */
+    void writeJsonString(const char* str) {
+        static const char hex[] = "0123456789abcdef";
+        put('"');
+        for (const char* c = str; *c != '\0'; c++) {
+            unsigned char u = static_cast<unsigned char>(*c);
+            if (u == '"' || u == '\\') {
+                put('\\');
+                put(*c);
+            } else if (u < 0x20) {
+                char escape[] = {'\\', 'u', '0', '0', hex[u >> 4], hex[u & 15]};
+                write(escape, sizeof(escape));
+            } else {
+                put(*c);
+            }
+        }
+        put('"');
+    }
+
+    /**
+     * Writes a string as a CSV field, quoted only if it holds a separator, quote or line break.
+     * @param str The string
+     */
+    void writeCsvField(const char* str) {
+        if (std::strpbrk(str, ",\"\r\n") == nullptr) {
+            writeString(str);
+            return;
+        }
+        put('"');
+        for (const char* c = str; *c != '\0'; c++) {
+            if (*c == '"') {
+                put('"');
+            }
+            put(*c);
+        }
+        put('"');
+    }
+};
+
+/**
+ * Base of the schedule writers, which format every job into a buffered output as it is placed.
+ */
+class ScheduleWriter: public ScheduleSink {
+protected:
+    BufferedOutput& out;        ///< Output the schedule is written to
+    JobNameFunction jobNames;   ///< Name of every job, or empty to write ids
+    size_t numJobs = 0;         ///< Number of jobs written so far
+
+    /**
+     * @param jobId Id of the job
+     * @return Name of the job, or null if the job is written by id
+     */
+    const char* getJobName(JobId jobId) const {
+        return jobNames ? jobNames(jobId) : nullptr;
+    }
+public:
+    /**
+     * Constructor for ScheduleWriter.
+     * @param _out Output the schedule is written to
+     * @param _jobNames Name of every job, or empty to write ids
+     */
+    ScheduleWriter(BufferedOutput& _out, JobNameFunction _jobNames): out(_out), jobNames(std::move(_jobNames)) {}
+
+    /**
+     * @return Number of jobs written so far
+     */
+    size_t getNumJobs() const {
+        return numJobs;
+    }
+};
+
+/**
+ * Writes a schedule as readable sentences, one per job, followed by the makespan.
+ */
+class TextScheduleWriter: public ScheduleWriter {
+public:
+    /**
+     * Constructor for TextScheduleWriter.
+     * @param _out Output the schedule is written to
+     * @param _jobNames Name of every job, or empty to write ids
+     */
+    TextScheduleWriter(BufferedOutput& _out, JobNameFunction _jobNames): ScheduleWriter(_out, std::move(_jobNames)) {
+        out.writeString("Scheduled Order:\n");
+    }
+
+    void write(const ScheduledJob& scheduledJob) override {
+        numJobs++;
+        const char* name = getJobName(scheduledJob.jobId);
+        out.writeString(" Schedule Job \"");
+        if (name != nullptr) {
+            out.writeString(name);
+        } else {
+            out.writeInt(scheduledJob.jobId);
+        }
+        out.writeString("\" at machine ");
+        out.writeInt(scheduledJob.machineId);
+        out.writeString(" at time ");
+        out.writeInt(scheduledJob.scheduleTime);
+        out.writeString(" where execution starts at ");
+        out.writeInt(scheduledJob.startTime);
+        out.writeString(" and finishes at ");
+        out.writeInt(scheduledJob.finishTime);
+        out.put('\n');
+    }
+
+    void finish(int makespan) override {
+        out.writeString("\nMinimum time to complete workflow: ");
+        out.writeInt(makespan);
+        out.put('\n');
+        out.flush();
+    }
+};
+
+/**
+ * Writes a schedule as CSV with the header "job,machine,schedule_time,start_time,finish_time". The makespan is the
+ * largest finish time, so it isn't written.
+ */
+class CsvScheduleWriter: public ScheduleWriter {
+public:
+    using ScheduleWriter::ScheduleWriter;
+
+    void write(const ScheduledJob& scheduledJob) override {
+        if (numJobs++ == 0) {
+            out.writeString("job,machine,schedule_time,start_time,finish_time\n");
+        }
+        const char* name = getJobName(scheduledJob.jobId);
+        if (name != nullptr) {
+            out.writeCsvField(name);
+        } else {
+            out.writeInt(scheduledJob.jobId);
+        }
+        out.put(',');
+        out.writeInt(scheduledJob.machineId);
+        out.put(',');
+        out.writeInt(scheduledJob.scheduleTime);
+        out.put(',');
+        out.writeInt(scheduledJob.startTime);
+        out.put(',');
+        out.writeInt(scheduledJob.finishTime);
+        out.put('\n');
+    }
+
+    void finish(int) override {
+        if (numJobs == 0) {
+            out.writeString("job,machine,schedule_time,start_time,finish_time\n");
+        }
+        out.flush();
+    }
+};
+
+/**
+ * Writes a schedule as a JSON object {"jobs":[...],"makespan":N}, where every job is an object with the fields
+ * job, machine, scheduleTime, startTime and finishTime.
+ */
+class JsonScheduleWriter: public ScheduleWriter {
+public:
+    using ScheduleWriter::ScheduleWriter;
+
+    void write(const ScheduledJob& scheduledJob) override {
+        out.writeString(numJobs++ == 0 ? "{\"jobs\":[\n{\"job\":" : ",\n{\"job\":");
+        const char* name = getJobName(scheduledJob.jobId);
+        if (name != nullptr) {
+            out.writeJsonString(name);
+        } else {
+            out.writeInt(scheduledJob.jobId);
+        }
+        out.writeString(",\"machine\":");
+        out.writeInt(scheduledJob.machineId);
+        out.writeString(",\"scheduleTime\":");
+        out.writeInt(scheduledJob.scheduleTime);
+        out.writeString(",\"startTime\":");
+        out.writeInt(scheduledJob.startTime);
+        out.writeString(",\"finishTime\":");
+        out.writeInt(scheduledJob.finishTime);
+        out.put('}');
+    }
+
+    void finish(int makespan) override {
+        out.writeString(numJobs == 0 ? "{\"jobs\":[" : "\n");
+        out.writeString("],\"makespan\":");
+        out.writeInt(makespan);
+        out.writeString("}\n");
+        out.flush();
+    }
+};
+
+/**
+ * Writes a schedule in the Chrome trace event format, opened by chrome://tracing and Perfetto. Every job is a
+ * complete event on the track of its machine, from its start time for its execution time, one time unit being shown
+ * as one microsecond. The tracks are named after the machines at the end.
+ */
+class ChromeTraceWriter: public ScheduleWriter {
+private:
+    int numMachines = 0;    ///< One more than the largest machine id written so far
+public:
+    using ScheduleWriter::ScheduleWriter;
+
+    void write(const ScheduledJob& scheduledJob) override {
+        out.writeString(numJobs++ == 0 ? "{\"traceEvents\":[\n{\"name\":" : ",\n{\"name\":");
+        const char* name = getJobName(scheduledJob.jobId);
+        if (name != nullptr) {
+            out.writeJsonString(name);
+        } else {
+            out.put('"');
+            out.writeInt(scheduledJob.jobId);
+            out.put('"');
+        }
+        out.writeString(",\"ph\":\"X\",\"pid\":0,\"tid\":");
+        out.writeInt(scheduledJob.machineId);
+        out.writeString(",\"ts\":");
+        out.writeInt(scheduledJob.startTime);
+        out.writeString(",\"dur\":");
+        out.writeInt(scheduledJob.finishTime - scheduledJob.startTime);
+        out.writeString(",\"args\":{\"scheduleTime\":");
+        out.writeInt(scheduledJob.scheduleTime);
+        out.writeString("}}");
+        numMachines = std::max(numMachines, scheduledJob.machineId + 1);
+    }
+
+    void finish(int makespan) override {
+        out.writeString(numJobs == 0 ? "{\"traceEvents\":[\n" : ",\n");
+        out.writeString("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"Workflow\"}}");
+        for (int machine = 0; machine < numMachines; machine++) {
+            out.writeString(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":");
+            out.writeInt(machine);
+            out.writeString(",\"args\":{\"name\":\"Machine ");
+            out.writeInt(machine);
+            out.writeString("\"}}");
+        }
+        out.writeString("\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"makespan\":");
+        out.writeInt(makespan);
+        out.writeString("}}\n");
+        out.flush();
+    }
+};
+
+/**
+ * Writes a schedule in a compact binary format, in native byte order: the magic word "WSO1", then a record of five
+ * int32 per job holding its id, machine, schedule time, start time and finish time, then the magic word "WSOE", the
+ * number of jobs as uint32 and the makespan as int32. Jobs are written by id, since the records have a fixed size;
+ * their names are those of the workflow that was scheduled.
+ */
+class BinaryScheduleWriter: public ScheduleWriter {
+public:
+    enum : uint32_t {
+        MAGIC = 0x314F5357u,        ///< "WSO1" in little endian, first word of the file
+        END_MAGIC = 0x454F5357u     ///< "WSOE" in little endian, first word of the footer
+    };
+
+    /**
+     * Constructor for BinaryScheduleWriter.
+     * @param _out Output the schedule is written to
+     */
+    explicit BinaryScheduleWriter(BufferedOutput& _out): ScheduleWriter(_out, JobNameFunction()) {
+        uint32_t magic = MAGIC;
+        out.write(&magic, sizeof(magic));
+    }
+
+    void write(const ScheduledJob& scheduledJob) override {
+        int32_t record[] = {static_cast<int32_t>(scheduledJob.jobId), scheduledJob.machineId, scheduledJob.scheduleTime,
+                            scheduledJob.startTime, scheduledJob.finishTime};
+        out.write(record, sizeof(record));
+        numJobs++;
+    }
+
+    void finish(int makespan) override {
+        uint32_t footer[] = {END_MAGIC, static_cast<uint32_t>(numJobs), static_cast<uint32_t>(makespan)};
+        out.write(footer, sizeof(footer));
+        out.flush();
+    }
+};
+
+/**
+ * Creates the writer of a schedule format.
+ * @param format Format of the schedule
+ * @param out Output the schedule is written to, which must outlive the writer
+ * @param jobNames Name of every job, or empty to write ids; ignored by the binary format
+ * @return The writer
+ */
+inline std::unique_ptr<ScheduleWriter> makeScheduleWriter(ScheduleFormat format, BufferedOutput& out,
+                                                          JobNameFunction jobNames = JobNameFunction()) {
+    switch (format) {
+    case ScheduleFormat::Csv:
+        return std::unique_ptr<ScheduleWriter>(new CsvScheduleWriter(out, std::move(jobNames)));
+    case ScheduleFormat::Json:
+        return std::unique_ptr<ScheduleWriter>(new JsonScheduleWriter(out, std::move(jobNames)));
+    case ScheduleFormat::ChromeTrace:
+        return std::unique_ptr<ScheduleWriter>(new ChromeTraceWriter(out, std::move(jobNames)));
+    case ScheduleFormat::Binary:
+        return std::unique_ptr<ScheduleWriter>(new BinaryScheduleWriter(out));
+    default:
+        return std::unique_ptr<ScheduleWriter>(new TextScheduleWriter(out, std::move(jobNames)));
+    }
+}
@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <vector>
+#include "csr.h"
+#include "machines.h"
+#include "state.h"
+#include "stats.h"
+
+/**
+ * Represents a scheduled job, including information about the machine, scheduling time, start time, and finish time.
+ */
+struct ScheduledJob {
+    JobId jobId;         ///< Id of the job
+    int machineId;       ///< ID of the machine
+    int scheduleTime;    ///< Time when the job is scheduled in the machine
+    int startTime;       ///< Start time of job execution
+    int finishTime;      ///< Finish time of job execution
+
+    /**
+     * Constructor for ScheduledJob.
+     * @param _jobId Id of the job
+     * @param _machineId ID of the machine
+     * @param _scheduleTime Time when the job is scheduled
+     * @param _startTime Start time of job execution
+     * @param _finishTime Finish time of job execution
+     */
+    ScheduledJob(JobId _jobId, int _machineId, int _scheduleTime, int _startTime, int _finishTime):
+        jobId(_jobId), machineId(_machineId), scheduleTime(_scheduleTime), startTime(_startTime), finishTime(_finishTime) {}
+};
+typedef std::vector<ScheduledJob> ScheduleOrder;
+
+/**
+ * Receives the jobs of a schedule one at a time as they are placed, so that a schedule can be written out without
+ * keeping all of it in memory.
+ */
+class ScheduleSink {
+public:
+    virtual ~ScheduleSink() {}
+
+    /**
+     * Receives the next placed job.
+     * @param scheduledJob Scheduling information of the job
+     */
+    virtual void write(const ScheduledJob& scheduledJob) = 0;
+
+    /**
+     * Receives the makespan once all jobs are placed.
+     * @param makespan Time at which all machines finish all jobs
+     */
+    virtual void finish(int makespan) = 0;
+};
+
+// Available policies for choosing the start time of a job on a machine.
+enum class PlacementPolicy {
+    Append,     ///< The job runs after the last job of the machine
+    Insertion   ///< The job runs in the earliest idle gap of the machine that fits it, like the insertion variant of HEFT
+};
+
+// Represents the machine and start time chosen for a job.
+struct Placement {
+    int machine;        ///< ID of the machine
+    int startTime;      ///< Start time of job execution
+};
+
+/**
+ * Places jobs one at a time on the machine where they finish earliest, ties going to the machine with the smaller ID.
+ * Every predecessor of a job must be placed before the job.
+ */
+class JobPlacer {
+private:
+    PlacementPolicy policy;         ///< How the start time on a machine is chosen
+    MachineTournamentTree machines; ///< Finish time of the last job of every machine
+    MachineTimelines timelines;     ///< Idle gaps of every machine, only kept for insertion
+
+    // Latest data arrival from the predecessors on each machine, including communication time, and latest finish time
+    // of the predecessors on each machine, or -1. Only the entries of the machines listed in predMachines are set while
+    // a job is being placed.
+    std::vector<int> machineArrivalTime;
+    std::vector<int> machineLocalFinishTime;
+    std::vector<int> predMachines;
+    int latestArrival;              ///< Latest data arrival among all machines hosting a predecessor
+    int latestMachine;              ///< Machine with the latest data arrival, -1 if there is no predecessor
+    int secondLatestArrival;        ///< Latest data arrival among the other machines
+    int makespan = 0;               ///< Latest finish time among all placed jobs
+
+    /**
+     * Gathers the latest data arrival per machine hosting a predecessor, and the two latest among them on distinct machines.
+     * @param inEdges Incoming communications of the job
+     * @param state Placement of the predecessors
+     */
+    void gatherArrivals(Span<CSREdge> inEdges, const ScheduleState& state) {
+        latestArrival = 0;
+        latestMachine = -1;
+        secondLatestArrival = 0;
+        for (const CSREdge& comm: inEdges) {
+            int machine = state.machine[comm.job];
+            int finishTime = state.finishTime[comm.job];
+            if (machineArrivalTime[machine] < 0) {
+                predMachines.emplace_back(machine);
+            }
+            machineArrivalTime[machine] = std::max(machineArrivalTime[machine], finishTime + comm.commTime);
+            machineLocalFinishTime[machine] = std::max(machineLocalFinishTime[machine], finishTime);
+        }
+        for (int machine: predMachines) {
+            int arrival = machineArrivalTime[machine];
+            if (arrival > latestArrival) {
+                secondLatestArrival = latestArrival;
+                latestArrival = arrival;
+                latestMachine = machine;
+            } else if (arrival > secondLatestArrival) {
+                secondLatestArrival = arrival;
+            }
+        }
+    }
+
+    /**
+     * Resets the per-machine arrivals gathered for the last job.
+     */
+    void clearArrivals() {
+        for (int machine: predMachines) {
+            machineArrivalTime[machine] = -1;
+            machineLocalFinishTime[machine] = -1;
+        }
+        predMachines.clear();
+    }
+
+    /**
+     * On any machine, the job waits for the data from predecessors on other machines. Predecessors on the same machine
+     * need no communication time.
+     * @param machine ID of the machine
+     * @return Time when all data of the job is available on the machine
+     */
+    int getDataReadyTime(int machine) const {
+        int remoteArrival = machine == latestMachine ? secondLatestArrival : latestArrival;
+        return std::max(remoteArrival, machineLocalFinishTime[machine]);
+    }
+
+    /**
+     * Finds the machine with the earliest start time, appending after the last job of the machine.
+     * @return Chosen machine and start time
+     */
+    Placement findAppendPlacement() const {
+        // The job also waits for the machine, and a predecessor on the same machine finished before the machine became
+        // free anyway. Among machines hosting no predecessor, the start time only grows with the machine finish time,
+        // and the first machine free by max(latestArrival, earliest machine finish time) is at least as good as any of
+        // them. Evaluating it along with the machines hosting a predecessor finds the same machine as checking all K.
+        auto earliestStartTime = [&](int machine) {
+            WORKFLOW_STATS_ADD(machinesEvaluated, 1);
+            return std::max(machines.getFinishTime(machine), getDataReadyTime(machine));
+        };
+
+        Placement best;
+        best.machine = machines.findFirstFreeBy(std::max(latestArrival, machines.getEarliestFinishTime()));
+        best.startTime = earliestStartTime(best.machine);
+        for (int machine: predMachines) {
+            int startTime = earliestStartTime(machine);
+            if (startTime < best.startTime || (startTime == best.startTime && machine < best.machine)) {
+                best.startTime = startTime;
+                best.machine = machine;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * Finds the machine with the earliest start time, inserting into the earliest idle gap that fits the job.
+     * @param executionTime Execution time of the job
+     * @return Chosen machine and start time
+     */
+    Placement findInsertionPlacement(int executionTime) const {
+        Placement best = {-1, INT_MAX};
+        auto consider = [&](int machine, int startTime) {
+            WORKFLOW_STATS_ADD(machinesEvaluated, 1);
+            if (startTime < best.startTime || (startTime == best.startTime && machine < best.machine)) {
+                best.startTime = startTime;
+                best.machine = machine;
+            }
+        };
+
+        for (int machine: predMachines) {
+            consider(machine, timelines.findEarliestStart(machine, getDataReadyTime(machine), executionTime));
+        }
+
+        // Any other machine can't start the job before latestArrival, and either starts it after its last job,
+        // where the first machine free by max(latestArrival, earliest machine finish time) is at least as good as
+        // any of them as for appending, or in a gap. A gap holding the job from latestArrival on is as good as it
+        // gets, and otherwise the earliest gap after latestArrival that is long enough is the best one.
+        // Considering them for machines hosting a predecessor too is harmless, since the job can't start any later
+        // there than on the other machines.
+        int firstFree = machines.findFirstFreeBy(std::max(latestArrival, machines.getEarliestFinishTime()));
+        consider(firstFree, timelines.findEarliestStart(firstFree, getDataReadyTime(firstFree), executionTime));
+        if (best.startTime < latestArrival) {
+            return best;
+        }
+        timelines.forEachGapFrom(latestArrival, executionTime, [&](int machine) {
+            consider(machine, latestArrival);
+        });
+        int gapMachine, gapStartTime;
+        if (best.startTime > latestArrival && timelines.findFirstGapAfter(latestArrival, executionTime, gapMachine, gapStartTime)) {
+            consider(gapMachine, gapStartTime);
+        }
+        return best;
+    }
+public:
+    /**
+     * Constructor for JobPlacer, with every machine free from time zero.
+     * @param _numMachines Number of machines available for scheduling
+     * @param _policy How the start time on a machine is chosen
+     */
+    JobPlacer(int _numMachines, PlacementPolicy _policy = PlacementPolicy::Append):
+        policy(_policy), machines(_numMachines),
+        timelines(_policy == PlacementPolicy::Insertion ? _numMachines : 0),
+        machineArrivalTime(_numMachines, -1), machineLocalFinishTime(_numMachines, -1) {}
+
+    /**
+     * Finds where and when a job would start, without placing it.
+     * @param inEdges Incoming communications of the job
+     * @param executionTime Execution time of the job
+     * @param state Placement of the predecessors
+     * @return Chosen machine and start time
+     */
+    Placement findPlacement(Span<CSREdge> inEdges, int executionTime, const ScheduleState& state) {
+        gatherArrivals(inEdges, state);
+        Placement best = policy == PlacementPolicy::Insertion ? findInsertionPlacement(executionTime) : findAppendPlacement();
+        clearArrivals();
+        return best;
+    }
+
+    /**
+     * Finds when the data of a job is available on every machine, without placing it.
+     * With appending, a job starts on a machine once its data is available there and the machine is free.
+     * @param inEdges Incoming communications of the job
+     * @param state Placement of the predecessors
+     * @param machineReadyTimes Receives the machine and data ready time of every machine hosting a predecessor
+     * @return Data ready time on any other machine
+     */
+    int findDataReadyTimes(Span<CSREdge> inEdges, const ScheduleState& state, std::vector<std::pair<int, int>>& machineReadyTimes) {
+        gatherArrivals(inEdges, state);
+        machineReadyTimes.clear();
+        for (int machine: predMachines) {
+            machineReadyTimes.emplace_back(machine, getDataReadyTime(machine));
+        }
+        int dataArrivalTime = latestArrival;
+        WORKFLOW_STATS_ADD(machinesEvaluated, predMachines.size() + 1);
+        clearArrivals();
+        return dataArrivalTime;
+    }
+
+    /**
+     * Places a job at a given machine and start time, which must be free.
+     * @param job Id of the job
+     * @param placement Machine and start time of the job
+     * @param executionTime Execution time of the job
+     * @param state Placement of all jobs, updated with the job
+     * @return Scheduling information of the job
+     */
+    ScheduledJob place(JobId job, const Placement& placement, int executionTime, ScheduleState& state) {
+        int machineFinishTime = machines.getFinishTime(placement.machine);
+        int finishTime = placement.startTime + executionTime;
+        if (policy == PlacementPolicy::Insertion) {
+            timelines.occupy(placement.machine, placement.startTime, finishTime);
+        }
+        // with insertion, jobs of zero length don't occupy the machine, and jobs running after them may start earlier
+        if (policy == PlacementPolicy::Append || executionTime > 0) {
+            machines.setFinishTime(placement.machine, std::max(machineFinishTime, finishTime));
+        }
+        makespan = std::max(makespan, finishTime);
+        state.assign(job, placement.machine, placement.startTime, finishTime);
+        WORKFLOW_STATS_ADD(jobsPlaced, 1);
+        return ScheduledJob(job, placement.machine, machineFinishTime, placement.startTime, finishTime);
+    }
+
+    /**
+     * Places a job on the machine where it finishes earliest.
+     * @param job Id of the job
+     * @param inEdges Incoming communications of the job
+     * @param executionTime Execution time of the job
+     * @param state Placement of all jobs, updated with the job
+     * @return Scheduling information of the job
+     */
+    ScheduledJob place(JobId job, Span<CSREdge> inEdges, int executionTime, ScheduleState& state) {
+        Placement placement = findPlacement(inEdges, executionTime, state);
+        countCommSkips(inEdges, placement.machine, state);
+        return place(job, placement, executionTime, state);
+    }
+
+    /**
+     * Counts the communications of a job placed on a machine that cost nothing, since the predecessor runs on the
+     * same machine. Does nothing unless compiled with WORKFLOW_STATS.
+     * @param inEdges Incoming communications of the job
+     * @param machine ID of the machine of the job
+     * @param state Placement of the predecessors
+     */
+    static void countCommSkips(Span<CSREdge> inEdges, int machine, const ScheduleState& state) {
+#ifdef WORKFLOW_STATS
+        for (const CSREdge& comm: inEdges) {
+            WORKFLOW_STATS_ADD(commSkips, state.machine[comm.job] == machine);
+        }
+#else
+        (void) inEdges;
+        (void) machine;
+        (void) state;
+#endif
+    }
+
+    /**
+     * Continues from machines busy until given times, as left by placing other jobs before, only with appending.
+     * @param finishTimes Finish time of the last job of every machine
+     */
+    void setFinishTimes(const std::vector<int>& finishTimes) {
+        for (size_t machine = 0; machine < finishTimes.size(); machine++) {
+            machines.setFinishTime(machine, finishTimes[machine]);
+            makespan = std::max(makespan, finishTimes[machine]);
+        }
+    }
+
+    /**
+     * @return How the start time on a machine is chosen
+     */
+    PlacementPolicy getPolicy() const {
+        return policy;
+    }
+
+    /**
+     * @return Earliest finish time among all machines
+     */
+    int getEarliestFinishTime() const {
+        return machines.getEarliestFinishTime();
+    }
+
+    /**
+     * @param machine ID of the machine
+     * @return Time at which the machine finishes its last scheduled job
+     */
+    int getFinishTime(int machine) const {
+        return machines.getFinishTime(machine);
+    }
+
+    /**
+     * @return Time at which all machines finish all scheduled jobs
+     */
+    int getMakespan() const {
+        return makespan;
+    }
+};
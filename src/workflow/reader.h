@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Reads a text file one character at a time through a fixed-size buffer refilled in large chunks, so that files of
+ * any size are read with a single allocation and without a system call per line.
+ */
+class ChunkedReader {
+private:
+    std::unique_ptr<FILE, int (*)(FILE*)> file;  ///< The file being read
+    std::string path;           ///< Path of the file, for error messages
+    std::vector<char> buffer;   ///< Current chunk of the file
+    size_t position = 0;        ///< Position of the next character in the chunk
+    size_t end = 0;             ///< Number of characters in the chunk
+    size_t line = 1;            ///< Line of the next character
+
+    /**
+     * Reads the next chunk once the current one is consumed.
+     * @return True if there are characters left, false at the end of the file
+     */
+    bool refill() {
+        position = 0;
+        end = std::fread(buffer.data(), 1, buffer.size(), file.get());
+        return end > 0;
+    }
+public:
+    /**
+     * Opens a file for reading.
+     * @param _path Path of the file
+     * @param chunkSize Number of characters read at once
+     * @throws std::runtime_error if the file can't be opened
+     */
+    explicit ChunkedReader(const std::string& _path, size_t chunkSize = 1 << 20):
+        file(std::fopen(_path.c_str(), "rb"), std::fclose), path(_path), buffer(chunkSize) {
+        if (file == nullptr) {
+            throw std::runtime_error("Cannot open workflow file: " + path);
+        }
+    }
+
+    /**
+     * @return Next character without consuming it, or EOF at the end of the file
+     */
+    int peek() {
+        if (position == end && !refill()) {
+            return EOF;
+        }
+        return static_cast<unsigned char>(buffer[position]);
+    }
+
+    /**
+     * @return Next character, or EOF at the end of the file
+     */
+    int get() {
+        int c = peek();
+        if (c != EOF) {
+            position++;
+            line += c == '\n';
+        }
+        return c;
+    }
+
+    /**
+     * Consumes the next character if it is the given one.
+     * @param c Expected character
+     * @return True if it was consumed, false otherwise
+     */
+    bool accept(int c) {
+        if (peek() != c) {
+            return false;
+        }
+        get();
+        return true;
+    }
+
+    /**
+     * Consumes characters up to and including a delimiter.
+     * @param delimiter Last character consumed
+     */
+    void skipPast(int delimiter) {
+        for (int c = get(); c != delimiter && c != EOF; c = get()) {
+        }
+    }
+
+    /**
+     * Consumes characters up to and including a delimiter of several characters.
+     * @param delimiter Last characters consumed
+     */
+    void skipPast(const std::string& delimiter) {
+        std::string window;
+        for (int c = get(); c != EOF; c = get()) {
+            window += static_cast<char>(c);
+            if (window.size() > delimiter.size()) {
+                window.erase(window.begin());
+            }
+            if (window == delimiter) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Consumes spaces, tabs and line breaks.
+     */
+    void skipWhitespace() {
+        for (int c = peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r'; c = peek()) {
+            get();
+        }
+    }
+
+    /**
+     * Builds the exception for a syntax error at the current line.
+     * @param message Description of the error
+     * @return Exception to throw
+     */
+    std::runtime_error error(const std::string& message) const {
+        return error(message, line);
+    }
+
+    /**
+     * Builds the exception for a syntax error at a line already read.
+     * @param message Description of the error
+     * @param errorLine Line of the error
+     * @return Exception to throw
+     */
+    std::runtime_error error(const std::string& message, size_t errorLine) const {
+        return std::runtime_error(path + ":" + std::to_string(errorLine) + ": " + message);
+    }
+
+    /**
+     * @return Line of the next character
+     */
+    size_t getLine() const {
+        return line;
+    }
+};
+
+/**
+ * Parses a whole string as a number.
+ * @param str The string
+ * @param value Set to the number if the string is one
+ * @return True if the string is a number, false otherwise
+ */
+inline bool parseNumber(const std::string& str, double& value) {
+    if (str.empty()) {
+        return false;
+    }
+    char* last;
+    value = std::strtod(str.c_str(), &last);
+    return *last == '\0';
+}
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <queue>
+#include <stdexcept>
+#include <vector>
+#include "csr.h"
+
+/**
+ * Represents a job in the ready queue along with its precomputed priority,
+ * so that ordering the queue only needs plain integer comparisons.
+ */
+struct ReadyJob {
+    int priority;   ///< Critical weight of the job
+    JobId job;      ///< Id of the job
+
+    /**
+     * Constructor for ReadyJob.
+     * @param _priority Critical weight of the job
+     * @param _job Id of the job
+     */
+    ReadyJob(int _priority, JobId _job): priority(_priority), job(_job) {}
+};
+
+/**
+ * Maps priorities to unsigned keys that increase as priority decreases, so that sorting or bucketing keys in ascending
+ * order takes the most critical jobs first. The subtraction is done in unsigned arithmetic so that negative priorities
+ * take the keys above those of non-negative ones instead of overflowing.
+ * @param priority Any priority
+ * @return Key of the priority, from 0 for INT_MAX to UINT32_MAX for INT_MIN
+ */
+inline uint32_t toDescendingKey(int priority) {
+    return static_cast<uint32_t>(INT_MAX) - static_cast<uint32_t>(priority);
+}
+
+/**
+ * Functor for comparing jobs based on their priority with respect to criticality.
+ * Used in priority_queue for sorting jobs in decreasing order of job criticality.
+ * Ties are broken in favour of the job with the smaller id so that the order is deterministic.
+ * It holds no state, so copying it into the priority queue is free.
+ */
+class JobCriticalityCompare {
+public:
+    /**
+     * Comparison operator for jobs based on criticality.
+     * @param j1 First ready job
+     * @param j2 Second ready job
+     * @return True if j1 is less critical than j2, false otherwise
+     */
+    bool operator()(const ReadyJob& j1, const ReadyJob& j2) const {
+        return j1.priority < j2.priority || (j1.priority == j2.priority && j1.job > j2.job);
+    }
+};
+
+// Available ready queue implementations for the topological sort.
+// All of them pop jobs in the same order: highest priority first, smaller id first among equal priorities.
+enum class ReadyQueueType {
+    BinaryHeap,     ///< std::priority_queue backed binary heap
+    DaryHeap,       ///< Implicit 4-ary heap, shallower and more cache-friendly than the binary heap
+    RadixHeap       ///< Monotone radix heap exploiting that popped priorities never increase
+};
+
+/**
+ * Ready queue backed by std::priority_queue.
+ */
+class BinaryHeapReadyQueue {
+private:
+    std::priority_queue<ReadyJob, std::vector<ReadyJob>, JobCriticalityCompare> pq;  ///< Underlying binary max heap
+public:
+    /**
+     * Inserts a job into the queue.
+     * @param job Job with its priority
+     */
+    void push(const ReadyJob& job) {
+        pq.push(job);
+    }
+
+    /**
+     * Removes the most critical job from the queue.
+     * @return Most critical job
+     */
+    ReadyJob pop() {
+        ReadyJob top = pq.top();
+        pq.pop();
+        return top;
+    }
+
+    /**
+     * @return True if there is no job in the queue, false otherwise
+     */
+    bool empty() const {
+        return pq.empty();
+    }
+};
+
+/**
+ * Ready queue backed by an implicit D-ary max heap.
+ * A larger arity halves the height of the heap for every doubling of D, trading a few more comparisons per level
+ * for fewer levels and better locality, since all children of a node share a cache line.
+ */
+template <unsigned D>
+class DaryHeapReadyQueue {
+private:
+    std::vector<ReadyJob> heap;     ///< Heap array, children of node i are D * i + 1 ... D * i + D
+    JobCriticalityCompare less;     ///< Ordering of the jobs
+public:
+    /**
+     * Inserts a job into the queue.
+     * @param job Job with its priority
+     */
+    void push(const ReadyJob& job) {
+        size_t i = heap.size();
+        heap.emplace_back(job);
+        while (i > 0) {
+            size_t parent = (i - 1) / D;
+            if (!less(heap[parent], job)) {
+                break;
+            }
+            heap[i] = heap[parent];
+            i = parent;
+        }
+        heap[i] = job;
+    }
+
+    /**
+     * Removes the most critical job from the queue.
+     * @return Most critical job
+     */
+    ReadyJob pop() {
+        ReadyJob top = heap.front();
+        ReadyJob last = heap.back();
+        heap.pop_back();
+        size_t size = heap.size();
+        if (size == 0) {
+            return top;
+        }
+
+        size_t i = 0;
+        while (true) {
+            size_t firstChild = D * i + 1;
+            if (firstChild >= size) {
+                break;
+            }
+            size_t best = firstChild;
+            size_t lastChild = std::min(firstChild + D, size);
+            for (size_t child = firstChild + 1; child < lastChild; child++) {
+                if (less(heap[best], heap[child])) {
+                    best = child;
+                }
+            }
+            if (!less(last, heap[best])) {
+                break;
+            }
+            heap[i] = heap[best];
+            i = best;
+        }
+        heap[i] = last;
+        return top;
+    }
+
+    /**
+     * @return True if there is no job in the queue, false otherwise
+     */
+    bool empty() const {
+        return heap.empty();
+    }
+};
+
+/**
+ * Monotone radix heap keyed by priority.
+ * In the topological sort a job only becomes ready once its predecessor is popped, and its critical weight never
+ * exceeds that of the predecessor, so popped priorities never increase. The radix heap exploits this: jobs are kept
+ * in 33 buckets according to the highest bit in which their key differs from the last popped key, and each job moves
+ * to a lower bucket at most 32 times, making push O(1) and pop amortized O(log C) for the critical path length C.
+ * Jobs of equal priority to the last popped one are kept in a small heap by id to preserve the tie-breaking order.
+ */
+class RadixHeapReadyQueue {
+private:
+    static const int NUM_BUCKETS = 33;
+
+    std::vector<JobId> current;                 ///< Heap by id of the jobs whose key equals lastKey
+    std::vector<ReadyJob> buckets[NUM_BUCKETS]; ///< Bucket b > 0 holds jobs whose key differs from lastKey first in bit b - 1
+    uint32_t lastKey = 0;                       ///< Key of the last popped job
+    size_t count = 0;                           ///< Number of jobs in the queue
+
+    /**
+     * @param key Radix heap key
+     * @return Priority mapped to the key by toDescendingKey()
+     */
+    static int toPriority(uint32_t key) {
+        return key <= static_cast<uint32_t>(INT_MAX) ? INT_MAX - static_cast<int>(key)
+                                                     : -1 - static_cast<int>(key - static_cast<uint32_t>(INT_MAX) - 1);
+    }
+
+    /**
+     * @param key Radix heap key
+     * @return Bucket of the key relative to lastKey
+     */
+    int bucketOf(uint32_t key) const {
+        uint32_t diff = key ^ lastKey;
+        return diff == 0 ? 0 : 32 - __builtin_clz(diff);
+    }
+
+    /**
+     * Heap order on ids for jobs of equal priority, smaller ids first.
+     */
+    static bool greaterId(JobId a, JobId b) {
+        return a > b;
+    }
+public:
+    /**
+     * Inserts a job into the queue.
+     * @param job Job with its priority, which must not exceed the priority of the last popped job
+     * @throws std::invalid_argument if the priority is higher than that of the last popped job
+     */
+    void push(const ReadyJob& job) {
+        uint32_t key = toDescendingKey(job.priority);
+        if (key < lastKey) {
+            throw std::invalid_argument("RadixHeapReadyQueue requires non-increasing priorities");
+        }
+
+        int bucket = bucketOf(key);
+        if (bucket == 0) {
+            current.emplace_back(job.job);
+            std::push_heap(current.begin(), current.end(), greaterId);
+        } else {
+            buckets[bucket].emplace_back(job);
+        }
+        count++;
+    }
+
+    /**
+     * Removes the most critical job from the queue.
+     * @return Most critical job
+     */
+    ReadyJob pop() {
+        if (current.empty()) {
+            // find the smallest key in the first non-empty bucket and redistribute the bucket around it
+            int bucket = 1;
+            while (buckets[bucket].empty()) {
+                bucket++;
+            }
+
+            std::vector<ReadyJob> jobs;
+            jobs.swap(buckets[bucket]);
+            lastKey = toDescendingKey(jobs.front().priority);
+            for (const ReadyJob& job: jobs) {
+                lastKey = std::min(lastKey, toDescendingKey(job.priority));
+            }
+            for (const ReadyJob& job: jobs) {
+                int newBucket = bucketOf(toDescendingKey(job.priority));
+                if (newBucket == 0) {
+                    current.emplace_back(job.job);
+                } else {
+                    buckets[newBucket].emplace_back(job);
+                }
+            }
+            std::make_heap(current.begin(), current.end(), greaterId);
+            // hand the storage back so the bucket doesn't reallocate on refill
+            jobs.clear();
+            if (buckets[bucket].empty()) {
+                buckets[bucket].swap(jobs);
+            }
+        }
+
+        std::pop_heap(current.begin(), current.end(), greaterId);
+        JobId job = current.back();
+        current.pop_back();
+        count--;
+        return ReadyJob(toPriority(lastKey), job);
+    }
+
+    /**
+     * @return True if there is no job in the queue, false otherwise
+     */
+    bool empty() const {
+        return count == 0;
+    }
+};
@@ -1,191 +1,485 @@
-#include <queue>
+#pragma once
+
+#include <cstdint>
+#include "cache.h"
+#include "critical.h"
+#include "dynamic.h"
 #include "graph.h"
+#include "placement.h"
+#include "ready_queue.h"
+#include "stats.h"
+#include "topological.h"
 
-/**
- * Functor for comparing jobs based on their priority with respect to criticality.
- * Used in priority_queue for sorting jobs in decreasing order of job criticality.
- */
-class JobCriticalityCompare {
+// Represents a schedule for a workflow on multiple machines.
+class WorkflowSchedule {
 private:
-    WorkflowGraph* graph;   ///< Pointer to the WorkflowGraph object
-    std::unordered_map<Job*, int> jobCriticalWeights;  ///< Maximum sum of job execution and communication time from the job to terminal job
-public:
+    WorkflowGraph* graph;   ///< Pointer to the WorkflowGraph object, null when scheduling a frozen graph directly
+    const CSRWorkflowGraph* frozenGraph;  ///< Pointer to the frozen graph when there is no WorkflowGraph
+    int numMachines;        ///< Number of machines available for scheduling
+    ReadyQueueType readyQueueType = ReadyQueueType::BinaryHeap;  ///< Ready queue used by the topological sort
+    ThreadPool* threadPool = nullptr;  ///< Threads for the parallel phases, null to run everything on the calling thread
+    bool parallelSort = false;         ///< Whether the topological sort runs on the thread pool
+    bool deterministicSort = true;     ///< Whether the parallel topological sort must match the serial order
+    PlacementPolicy placementPolicy = PlacementPolicy::Append;  ///< How the start time of a job on a machine is chosen
+    OrderingPolicy orderingPolicy = OrderingPolicy::StaticCriticalPath;  ///< Order in which jobs are placed
+    ScheduleCache* scheduleCache = nullptr;  ///< Cache of schedules by workflow content, null to always compute them
+
+    // Result of the last reschedule(), along with what it was computed from, kept to update it after changes
+    bool canUpdateSchedule = false;         ///< Whether the fields below can be updated instead of computed again
+    std::vector<int> lastCriticalWeights;   ///< Critical weight of every job
+    std::vector<JobId> lastTopOrder;        ///< Topological order of the jobs
+    std::vector<uint32_t> lastPositions;    ///< Position of every job in lastTopOrder, UINT32_MAX for jobs added since
+    ScheduleState lastState;                ///< Placement of every job
+    ScheduleOrder lastScheduleOrder;        ///< Scheduled jobs in topological order
+    std::vector<int> lastFinishTimes;       ///< Finish time of every machine
+    int lastMakespan = 0;                   ///< Time at which all machines finish all jobs
+
     /**
-     * Constructor for JobCriticalityCompare.
-     * @param _graph Pointer to the WorkflowGraph object
+     * @return Frozen form of the graph being scheduled
      */
-    JobCriticalityCompare(WorkflowGraph* _graph): graph(_graph) {}
+    const CSRWorkflowGraph& getGraph() {
+        return graph != nullptr ? graph->freeze() : *frozenGraph;
+    }
 
     /**
-     * Get the critical weight of a job, considering maximum execution and communication times
-     * among all the paths from the specified job to the terminal job.
-     * @param job Strating job
-     * @return Maximum sum of job execution and communication time from the job to terminal job
+     * Kahn's topological sort using the given ready queue, extending an order with the jobs not in it yet.
+     * @param csr Frozen workflow graph
+     * @param criticalWeights Critical weight of every job, used as its priority
+     * @param inDegrees Number of predecessors of every job not in the order yet that aren't in it either
+     * @param readyJobs Jobs not in the order yet whose predecessors all are
+     * @param order Topological order to extend
      */
-    int getJobCriticalWeight(Job* job) {
-        // if precalculated return it
-        auto jobCriticalWeightPtr = jobCriticalWeights.find(job);
-        if (jobCriticalWeightPtr != jobCriticalWeights.end()) {
-            return jobCriticalWeightPtr->second;
+    template <class ReadyQueue>
+    static void extendTopologicalOrder(const CSRWorkflowGraph& csr, const std::vector<int>& criticalWeights,
+                                       std::vector<int>& inDegrees, const std::vector<JobId>& readyJobs,
+                                       std::vector<JobId>& order) {
+        // Use priority queue so that among the jobs that can be run simultaneously,
+        // highest priority job based on JobCriticalityCompare will be scheduled first.
+        ReadyQueue pq;
+        for (JobId job: readyJobs) {
+            pq.push(ReadyJob(criticalWeights[job], job));
         }
+        WORKFLOW_STATS_ADD(heapPushes, readyJobs.size());
+
+        while (!pq.empty()) {
+            JobId front = pq.pop().job;
+            order.emplace_back(front);
+            WORKFLOW_STATS_ADD(heapPops, 1);
 
-        int jobCriticalWeight = 0;
-        for (const auto& comm: graph->getOutCommunications(job)) {
-            int currJobCriticalWeight = comm->commTime + getJobCriticalWeight(comm->toJob);
-            if (jobCriticalWeight < currJobCriticalWeight) {
-                jobCriticalWeight = currJobCriticalWeight;
+            for (const CSREdge& comm: csr.getOutEdges(front)) {
+                inDegrees[comm.job]--;
+
+                if (inDegrees[comm.job] == 0) {
+                    pq.push(ReadyJob(criticalWeights[comm.job], comm.job));
+                    WORKFLOW_STATS_ADD(heapPushes, 1);
+                }
             }
         }
-        jobCriticalWeight += job->executionTime;
-        
-        // store so that recalculation can be avoided.
-        jobCriticalWeights[job] = jobCriticalWeight;
-        return jobCriticalWeight;
     }
 
     /**
-     * Comparison operator for jobs based on criticality.
-     * @param j1 Pointer to the first job
-     * @param j2 Pointer to the second job
-     * @return True if j1 is less critical than j2, false otherwise
+     * Kahn's topological sort using the ready queue of the schedule, extending an order with the jobs not in it yet.
+     * @param csr Frozen workflow graph
+     * @param criticalWeights Critical weight of every job, used as its priority
+     * @param inDegrees Number of predecessors of every job not in the order yet that aren't in it either
+     * @param readyJobs Jobs not in the order yet whose predecessors all are
+     * @param order Topological order to extend
      */
-    bool operator()(Job* j1, Job* j2) {
-        return getJobCriticalWeight(j1) < getJobCriticalWeight(j2);
+    void extendTopologicalOrder(const CSRWorkflowGraph& csr, const std::vector<int>& criticalWeights,
+                                std::vector<int>& inDegrees, const std::vector<JobId>& readyJobs, std::vector<JobId>& order) const {
+        switch (readyQueueType) {
+        case ReadyQueueType::DaryHeap:
+            extendTopologicalOrder<DaryHeapReadyQueue<4>>(csr, criticalWeights, inDegrees, readyJobs, order);
+            break;
+        case ReadyQueueType::RadixHeap:
+            extendTopologicalOrder<RadixHeapReadyQueue>(csr, criticalWeights, inDegrees, readyJobs, order);
+            break;
+        default:
+            extendTopologicalOrder<BinaryHeapReadyQueue>(csr, criticalWeights, inDegrees, readyJobs, order);
+        }
     }
-};
 
-/**
- * Represents a scheduled job, including information about the machine, scheduling time, start time, and finish time.
- */
-struct ScheduledJob {
-    Job* job;            ///< Pointer to the job
-    int machineId;       ///< ID of the machine
-    int scheduleTime;    ///< Time when the job is scheduled in the machine
-    int startTime;       ///< Start time of job execution
-    int finishTime;      ///< Finish time of job execution
-
-    /**
-     * Constructor for ScheduledJob.
-     * @param _job Pointer to the Job object
-     * @param _machineId ID of the machine
-     * @param _scheduleTime Time when the job is scheduled
-     * @param _startTime Start time of job execution
-     * @param _finishTime Finish time of job execution
-     */
-    ScheduledJob(Job* _job, int _machineId, int _scheduleTime, int _startTime, int _finishTime):
-        job(_job), machineId(_machineId), scheduleTime(_scheduleTime), startTime(_startTime), finishTime(_finishTime) {}
-};
-typedef std::vector<ScheduledJob> ScheduleOrder;
+    /**
+     * Updates the critical weights and the topological order of the last reschedule() after the graph changed.
+     * Kahn's sort pops the same jobs as before until a job whose critical weight, predecessors or execution time changed
+     * could become ready or was popped before, so the order is kept up to there and the rest is sorted again.
+     * @param csr Frozen workflow graph
+     * @return Number of jobs kept at the beginning of the order
+     */
+    size_t updateTopologicalOrder(const CSRWorkflowGraph& csr) {
+        size_t numJobs = csr.getNumJobs(), numOldJobs = lastPositions.size();
+        const std::vector<JobId>& dirtyJobs = graph->getDirtyJobs();
+        std::vector<JobId> updatedJobs;
+        {
+            WORKFLOW_STATS_PHASE(rank);
+            updatedJobs = updateCriticalWeights(csr, dirtyJobs, lastCriticalWeights);
+        }
+        WORKFLOW_STATS_PHASE(sort);
+        lastPositions.resize(numJobs, UINT32_MAX);
 
-// Represents a schedule for a workflow on multiple machines.
-class WorkflowSchedule {
-private:
-    WorkflowGraph* graph;   ///< Pointer to the WorkflowGraph object
-    int numMachines;        ///< Number of machines available for scheduling
+        // a job can't become ready before all of its predecessors are popped, and new jobs are never kept
+        size_t numKept = lastTopOrder.size();
+        auto keepBefore = [&](JobId job) {
+            size_t readyPosition = 0;
+            for (const CSREdge& comm: csr.getInEdges(job)) {
+                readyPosition = std::max<size_t>(readyPosition, lastPositions[comm.job] + size_t(1));
+            }
+            numKept = std::min<size_t>(numKept, std::min<size_t>(readyPosition, lastPositions[job]));
+        };
+        for (JobId job: dirtyJobs) {
+            keepBefore(job);
+        }
+        for (JobId job: updatedJobs) {
+            keepBefore(job);
+        }
+
+        std::vector<JobId> sortedJobs(lastTopOrder.begin() + numKept, lastTopOrder.end());
+        for (JobId job = numOldJobs; job < numJobs; job++) {
+            sortedJobs.emplace_back(job);
+        }
+        lastTopOrder.resize(numKept);
+
+        std::vector<int> inDegrees(numJobs, 0);
+        std::vector<JobId> readyJobs;
+        for (JobId job: sortedJobs) {
+            for (const CSREdge& comm: csr.getInEdges(job)) {
+                if (lastPositions[comm.job] >= numKept) {
+                    inDegrees[job]++;
+                }
+            }
+            if (inDegrees[job] == 0) {
+                readyJobs.emplace_back(job);
+            }
+        }
+        extendTopologicalOrder(csr, lastCriticalWeights, inDegrees, readyJobs, lastTopOrder);
+        return numKept;
+    }
+
+    /**
+     * Brings a placer to the state in which the last reschedule() left it after placing the jobs kept in the order.
+     * With appending, a machine is busy until the job placed on it after them was scheduled, or until its last job
+     * finishes if there is none, while with insertion the kept jobs are placed again at their start time.
+     * @param csr Frozen workflow graph
+     * @param numKept Number of jobs kept at the beginning of the order
+     * @param placer Placer with no job placed
+     */
+    void restorePlacement(const CSRWorkflowGraph& csr, size_t numKept, JobPlacer& placer) {
+        WORKFLOW_STATS_PHASE(place);
+        if (placementPolicy == PlacementPolicy::Append) {
+            std::vector<bool> isFound(numMachines, false);
+            for (size_t i = numKept; i < lastScheduleOrder.size(); i++) {
+                const ScheduledJob& scheduledJob = lastScheduleOrder[i];
+                if (!isFound[scheduledJob.machineId]) {
+                    isFound[scheduledJob.machineId] = true;
+                    lastFinishTimes[scheduledJob.machineId] = scheduledJob.scheduleTime;
+                }
+            }
+            placer.setFinishTimes(lastFinishTimes);
+            return;
+        }
+
+        for (size_t i = 0; i < numKept; i++) {
+            JobId job = lastTopOrder[i];
+            Placement placement = {lastState.machine[job], lastState.startTime[job]};
+            placer.place(job, placement, csr.getExecutionTime(job), lastState);
+        }
+    }
 public:
     /**
      * Constructor for WorkflowSchedule.
      * @param _graph Pointer to the WorkflowGraph object
      * @param _numMachines Number of machines available for scheduling
      */
-    WorkflowSchedule(WorkflowGraph* _graph, int _numMachines): graph(_graph), numMachines(_numMachines) {}
+    WorkflowSchedule(WorkflowGraph* _graph, int _numMachines): graph(_graph), frozenGraph(nullptr), numMachines(_numMachines) {}
+
+    /**
+     * Constructor for WorkflowSchedule scheduling an already frozen graph.
+     * @param _graph Pointer to the frozen workflow graph
+     * @param _numMachines Number of machines available for scheduling
+     */
+    WorkflowSchedule(const CSRWorkflowGraph* _graph, int _numMachines): graph(nullptr), frozenGraph(_graph), numMachines(_numMachines) {}
+
+    /**
+     * Selects the ready queue implementation used by the topological sort.
+     * All implementations produce the same order, they only differ in speed.
+     * @param type Ready queue implementation
+     */
+    void setReadyQueue(ReadyQueueType type) {
+        readyQueueType = type;
+    }
+
+    /**
+     * Selects how the start time of a job on a machine is chosen.
+     * Insertion reuses the idle gaps left while machines wait for communication, at the cost of evaluating more machines.
+     * @param policy Placement policy
+     */
+    void setPlacementPolicy(PlacementPolicy policy) {
+        placementPolicy = policy;
+        canUpdateSchedule = false;
+    }
+
+    /**
+     * Selects the order in which jobs are placed on machines.
+     * The static order sorts all jobs by critical weight before placing any of them, while the dynamic ones choose
+     * the next job among the ready ones against the machines as scheduled so far, in a single pass.
+     * @param policy Ordering policy
+     */
+    void setOrderingPolicy(OrderingPolicy policy) {
+        orderingPolicy = policy;
+    }
+
+    /**
+     * Selects the threads used for the parallel phases of scheduling.
+     * @param pool Thread pool, owned by the caller, or null to run everything on the calling thread
+     */
+    void setThreadPool(ThreadPool* pool) {
+        threadPool = pool;
+        canUpdateSchedule = false;
+    }
+
+    /**
+     * Selects whether the topological sort runs on the thread pool, which only takes effect once a pool is set.
+     * The deterministic parallel sort gives the same order as the serial one. It checks in parallel that sorting the
+     * jobs by priority respects every dependency, which always holds for positive execution times, and falls back to
+     * the serial sort otherwise. The non-deterministic one sorts by priority and then by level, without any fallback,
+     * and may order equally critical jobs differently from the serial sort.
+     * @param parallel True to sort on the thread pool, false to sort on the calling thread
+     * @param deterministic True to guarantee the serial order, false to allow any order by priority and level
+     */
+    void setParallelTopologicalSort(bool parallel, bool deterministic = true) {
+        parallelSort = parallel;
+        deterministicSort = deterministic;
+        canUpdateSchedule = false;
+    }
+
+    /**
+     * Selects the cache looked into by schedule() before computing a schedule, and filled with the schedules computed.
+     * Only workflows given as a WorkflowGraph are cached, since their jobs are identified by name.
+     * @param cache Schedule cache, owned by the caller and possibly shared by many schedules, or null for none
+     */
+    void setScheduleCache(ScheduleCache* cache) {
+        scheduleCache = cache;
+    }
+
+    /**
+     * Calculates the critical weight of every job, in parallel if a thread pool is set.
+     * @return Vector of critical weights indexed by job id
+     */
+    std::vector<int> getCriticalWeights() {
+        WORKFLOW_STATS_PHASE(rank);
+        const CSRWorkflowGraph& csr = getGraph();
+        return threadPool != nullptr ? computeCriticalWeights(csr, *threadPool) : computeCriticalWeights(csr);
+    }
 
     /**
      * Performs a topological sort of the workflow graph.
      * Among the executable jobs whose all predecessors are completed,
      * it gives priority to the job with highest critical weight. 
-     * @return Vector of Job representing the topological order
+     * @return Vector of job ids representing the topological order
      */
-    std::vector<Job*> topologicalSort() {
-        std::unordered_map<Job*, int> inDegrees = graph->getIndegrees();
-        
-        // Use priority queue so that among the jobs that can be run simultaneously,
-        // highest priority job based in the comparator defined below will be scheduled first.
-        JobCriticalityCompare comparator = JobCriticalityCompare(graph);
-        std::priority_queue<Job*, std::vector<Job*>, JobCriticalityCompare> pq(comparator);
-        for (const auto& inDeg: inDegrees) {
-            if (inDeg.second == 0) {
-                pq.push(inDeg.first);
+    std::vector<JobId> topologicalSort() {
+        // Priority of every job is its critical weight, computed once upfront.
+        return topologicalSort(getCriticalWeights());
+    }
+
+    /**
+     * Performs a topological sort of the workflow graph with precomputed critical weights.
+     * @param criticalWeights Critical weight of every job indexed by job id
+     * @return Vector of job ids representing the topological order
+     */
+    std::vector<JobId> topologicalSort(const std::vector<int>& criticalWeights) {
+        WORKFLOW_STATS_PHASE(sort);
+        const CSRWorkflowGraph& csr = getGraph();
+        if (threadPool != nullptr && parallelSort) {
+            if (!deterministicSort) {
+                return sortByLevelAndCriticality(csr, criticalWeights, *threadPool);
+            }
+            if (isCriticalityOrderTopological(csr, criticalWeights, *threadPool)) {
+                return sortByCriticality(criticalWeights, *threadPool);
             }
         }
 
-        std::vector<Job*> topOrder;
-        while (!pq.empty()) {
-            Job* front = pq.top();
-            pq.pop();
-            topOrder.emplace_back(front);
-
-            for (const auto& job: graph->getSuccessors(front)) {
-                inDegrees[job]--;
-
-                if (inDegrees[job] == 0) {
-                    pq.push(job);
-                }
+        std::vector<int> inDegrees(csr.getNumJobs());
+        std::vector<JobId> readyJobs;
+        for (JobId job = 0; job < csr.getNumJobs(); job++) {
+            inDegrees[job] = csr.getIndegree(job);
+            if (inDegrees[job] == 0) {
+                readyJobs.emplace_back(job);
             }
         }
-        
-        return topOrder;
+
+        std::vector<JobId> order;
+        order.reserve(csr.getNumJobs());
+        extendTopologicalOrder(csr, criticalWeights, inDegrees, readyJobs, order);
+        return order;
     }
 
     /**
      * Schedules the workflow on multiple machines and calculates the makespan.
-     * Based on the topological order of the graph, job is scheduled in the machine where it'll be finished earlier.
+     * Based on the topological order of the graph, or on the dynamic priorities of the ready jobs depending on the
+     * ordering policy, job is scheduled in the machine where it'll be finished earlier, after the last job of the
+     * machine or in an earlier idle gap depending on the placement policy.
+     * With a schedule cache, a workflow with the same content as one scheduled before with the same settings gets the
+     * cached schedule.
      * @return Pair containing the makespan and a vector of Job along with scheduling information representing the schedule order
      */
     std::pair<int, ScheduleOrder> schedule() {
+        if (scheduleCache == nullptr || graph == nullptr) {
+            return computeSchedule();
+        }
+
+        ScheduleCacheKey key = {graph->getContentHash(), numMachines, placementPolicy, orderingPolicy};
+        std::pair<int, ScheduleOrder> result;
+        if (!scheduleCache->find(key, *graph, result)) {
+            result = computeSchedule();
+            scheduleCache->insert(key, *graph, result);
+        }
+        return result;
+    }
+
+    /**
+     * Schedules the workflow on multiple machines and calculates the makespan, without looking into the cache.
+     * @return Pair containing the makespan and a vector of Job along with scheduling information representing the schedule order
+     */
+    std::pair<int, ScheduleOrder> computeSchedule() {
         ScheduleOrder scheduleOrder;  // Final scheduling result to return
-        std::vector<Job*> topOrder = topologicalSort();
+        scheduleOrder.reserve(getGraph().getNumJobs());
+        int makespan = computeSchedule([&](const ScheduledJob& scheduledJob) { scheduleOrder.emplace_back(scheduledJob); });
+        return {makespan, scheduleOrder};
+    }
+
+    /**
+     * Schedules the workflow on multiple machines, handing every job over as soon as it is placed, without looking
+     * into the cache.
+     * @param emit Called with the scheduling information of every job, in the order they are placed
+     * @return Makespan of the schedule
+     */
+    template <class Emit>
+    int computeSchedule(Emit emit) {
+        std::vector<int> criticalWeights = getCriticalWeights();
+        if (orderingPolicy != OrderingPolicy::StaticCriticalPath) {
+            return placeByPriority(criticalWeights, emit);
+        }
+        return placeInOrder(topologicalSort(criticalWeights), emit);
+    }
 
-        std::vector<int> machineFinishTime(numMachines, 0);
-        std::unordered_map<Job*, int> jobFinishTime;
-        std::unordered_map<Job*, int> job2machineMap;
+    /**
+     * Places jobs on machines one by one in a given order, which is the last step of scheduling with the static
+     * ordering policy.
+     * @param topOrder Topological order of all jobs
+     * @param emit Called with the scheduling information of every job, in the order they are placed
+     * @return Makespan of the schedule
+     */
+    template <class Emit>
+    int placeInOrder(const std::vector<JobId>& topOrder, Emit emit) {
+        WORKFLOW_STATS_PHASE(place);
+        const CSRWorkflowGraph& csr = getGraph();
 
+        JobPlacer placer(numMachines, placementPolicy);
+        ScheduleState state(csr.getNumJobs());
         for (const auto& job: topOrder) {
+            emit(placer.place(job, csr.getInEdges(job), csr.getExecutionTime(job), state));
+        }
 
-            // Find machine which will finish the current job earliest
-            // First find finish time in each machine along with other information
-            std::vector<ScheduledJob> candidateSchedules;
-            for (int machine = 0; machine<numMachines; machine++) {
-                // Earliest start time is maximum of machine finish time and max weight time from predecessors.
-                int earliestStartTime = machineFinishTime[machine];
-                for (const Communication* comm: graph->getInCommunications(job)) {
-                    if (machine == job2machineMap[comm->fromJob]) {
-                        // if predecessor job was executed in the same machine, no communication time is needed.
-                        continue;
-                    }
-                    earliestStartTime = std::max(earliestStartTime, jobFinishTime[comm->fromJob] + comm->commTime);
-                }
+        return placer.getMakespan();
+    }
+
+    /**
+     * Orders and places jobs in a single pass with a dynamic ordering policy, choosing every next job among the ready
+     * ones by its priority against the machines as scheduled so far.
+     * @param criticalWeights Critical weight of every job indexed by job id
+     * @param emit Called with the scheduling information of every job, in the order they are placed
+     * @return Makespan of the schedule
+     */
+    template <class Emit>
+    int placeByPriority(const std::vector<int>& criticalWeights, Emit emit) {
+        WORKFLOW_STATS_PHASE(place);
+        DynamicListScheduler scheduler(getGraph(), criticalWeights, numMachines, placementPolicy, orderingPolicy);
+        return scheduler.schedule(emit);
+    }
 
-                int earliestFinishTime = earliestStartTime + job->executionTime;
-                candidateSchedules.emplace_back(
-                    ScheduledJob(job, machine, machineFinishTime[machine], earliestStartTime, earliestFinishTime)
-                );
+    /**
+     * Schedules the workflow like schedule(), writing every job into a sink as soon as it is placed instead of
+     * returning them all. With a schedule cache, the whole schedule is kept to be cached, and written out afterwards.
+     * @param sink Receives the jobs in the order they are placed, and then the makespan
+     * @return Makespan of the schedule
+     */
+    int schedule(ScheduleSink& sink) {
+        int makespan;
+        if (scheduleCache != nullptr && graph != nullptr) {
+            std::pair<int, ScheduleOrder> result = schedule();
+            for (const ScheduledJob& scheduledJob: result.second) {
+                sink.write(scheduledJob);
             }
+            makespan = result.first;
+        } else {
+            makespan = computeSchedule([&](const ScheduledJob& scheduledJob) { sink.write(scheduledJob); });
+        }
+        sink.finish(makespan);
+        return makespan;
+    }
 
-            // Select the best machine and its schedule information
-            ScheduledJob& bestSchedule = candidateSchedules.front();
-            for (auto sch = candidateSchedules.begin(); sch != candidateSchedules.end(); sch++) {
-                if (bestSchedule.finishTime > sch->finishTime) {
-                    bestSchedule = *sch;
-                }
+    /**
+     * Schedules the workflow again after it changed, updating the result of the last reschedule() instead of computing
+     * it from scratch, with the same result as schedule().
+     * Only the jobs changed in the graph since then and their ancestors get their critical weight calculated again, and
+     * the topological order and the placement are kept up to the first position where a changed job could become ready
+     * or was placed, so only the rest is sorted and placed again. The first call, and every call with a dynamic
+     * ordering policy, a non-deterministic parallel sort or a frozen graph, schedules the whole workflow.
+     * @return Makespan of the schedule, whose jobs are given by getScheduleOrder()
+     */
+    int reschedule() {
+        if (orderingPolicy != OrderingPolicy::StaticCriticalPath) {
+            std::pair<int, ScheduleOrder> result = schedule();
+            lastMakespan = result.first;
+            lastScheduleOrder.swap(result.second);
+            canUpdateSchedule = false;
+            if (graph != nullptr) {
+                graph->clearDirtyJobs();
             }
+            return lastMakespan;
+        }
 
-            // add the schedule in result schedule order
-            scheduleOrder.emplace_back(bestSchedule);
+        const CSRWorkflowGraph& csr = getGraph();
+        size_t numJobs = csr.getNumJobs();
+        JobPlacer placer(numMachines, placementPolicy);
+        size_t numKept = 0;
+        if (canUpdateSchedule) {
+            numKept = updateTopologicalOrder(csr);
+            restorePlacement(csr, numKept, placer);
+        } else {
+            lastCriticalWeights = getCriticalWeights();
+            lastTopOrder = topologicalSort(lastCriticalWeights);
+            lastPositions.assign(numJobs, UINT32_MAX);
+            lastState = ScheduleState(numJobs);
+        }
 
-            // log info for next job scheduling
-            machineFinishTime[bestSchedule.machineId] = bestSchedule.finishTime;
-            jobFinishTime[job] = bestSchedule.finishTime;
-            job2machineMap[job] = bestSchedule.machineId;
+        WORKFLOW_STATS_PHASE(place);
+        lastState.resize(numJobs);
+        lastScheduleOrder.resize(numKept, ScheduledJob(0, 0, 0, 0, 0));
+        for (size_t i = numKept; i < lastTopOrder.size(); i++) {
+            JobId job = lastTopOrder[i];
+            lastPositions[job] = i;
+            lastScheduleOrder.emplace_back(placer.place(job, csr.getInEdges(job), csr.getExecutionTime(job), lastState));
+        }
+        lastFinishTimes.resize(numMachines);
+        for (int machine = 0; machine < numMachines; machine++) {
+            lastFinishTimes[machine] = placer.getFinishTime(machine);
         }
+        lastMakespan = placer.getMakespan();
 
-        int makespan = 0;
-        for (const int& mTime: machineFinishTime) {
-            if (makespan < mTime) {
-                makespan = mTime;
-            }
+        // jobs changed later are only known through the WorkflowGraph, and the other sort orders can't be resumed
+        canUpdateSchedule = graph != nullptr && (threadPool == nullptr || !parallelSort || deterministicSort);
+        if (graph != nullptr) {
+            graph->clearDirtyJobs();
         }
+        return lastMakespan;
+    }
 
-        return {makespan, scheduleOrder};
+    /**
+     * @return Jobs along with scheduling information in the order they were placed by the last reschedule()
+     */
+    const ScheduleOrder& getScheduleOrder() const {
+        return lastScheduleOrder;
     }
 };
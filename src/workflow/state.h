@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include "csr.h"
+
+/**
+ * Per-job scheduling state stored as a structure of arrays indexed by job id,
+ * so that looking up where and when a predecessor ran is a plain array load.
+ */
+struct ScheduleState {
+    std::vector<int> startTime;     ///< Start time of job execution
+    std::vector<int> finishTime;    ///< Finish time of job execution
+    std::vector<int> machine;       ///< ID of the machine the job runs on, -1 if the job is not scheduled yet
+
+    /**
+     * Constructor for ScheduleState with no job scheduled.
+     * @param numJobs Number of jobs
+     */
+    explicit ScheduleState(size_t numJobs = 0): startTime(numJobs, 0), finishTime(numJobs, 0), machine(numJobs, -1) {}
+
+    /**
+     * Changes the number of jobs, new jobs are not scheduled.
+     * @param numJobs Number of jobs
+     */
+    void resize(size_t numJobs) {
+        startTime.resize(numJobs, 0);
+        finishTime.resize(numJobs, 0);
+        machine.resize(numJobs, -1);
+    }
+
+    /**
+     * @return Number of jobs
+     */
+    size_t size() const {
+        return machine.size();
+    }
+
+    /**
+     * @param job Id of the job
+     * @return True if the job has been assigned to a machine, false otherwise
+     */
+    bool isScheduled(JobId job) const {
+        return machine[job] >= 0;
+    }
+
+    /**
+     * Records the placement of a job.
+     * @param job Id of the job
+     * @param _machine ID of the machine
+     * @param _startTime Start time of job execution
+     * @param _finishTime Finish time of job execution
+     */
+    void assign(JobId job, int _machine, int _startTime, int _finishTime) {
+        machine[job] = _machine;
+        startTime[job] = _startTime;
+        finishTime[job] = _finishTime;
+    }
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <sys/resource.h>
+
+/**
+ * Counters and phase timers of scheduling, collected only when compiled with -DWORKFLOW_STATS (make STATS=1).
+ * Without it, the instrumentation macros expand to nothing and scheduling runs exactly as uninstrumented code.
+ * Every thread accumulates into its own ScheduleStats, obtained with getScheduleStats(), across all schedules it
+ * computes until it is reset. Work handed to a thread pool is timed as part of its phase on the calling thread, but
+ * isn't counted.
+ */
+struct ScheduleStats {
+#ifdef WORKFLOW_STATS
+    static constexpr bool isEnabled = true;     ///< Whether the library was compiled with instrumentation
+#else
+    static constexpr bool isEnabled = false;    ///< Whether the library was compiled with instrumentation
+#endif
+
+    uint64_t rankNanoseconds = 0;   ///< Time spent computing critical weights
+    uint64_t sortNanoseconds = 0;   ///< Time spent sorting jobs topologically
+    uint64_t placeNanoseconds = 0;  ///< Time spent placing jobs, including choosing the next one for dynamic orders
+    uint64_t heapPushes = 0;        ///< Jobs pushed into the ready heaps of the topological sort and dynamic orders
+    uint64_t heapPops = 0;          ///< Jobs popped from these heaps, including stale entries dropped
+    uint64_t jobsPlaced = 0;        ///< Jobs placed on a machine
+    uint64_t machinesEvaluated = 0; ///< Start times evaluated on a machine, or a gap of one, to place or rank a job
+    uint64_t commSkips = 0;         ///< Communications not paid since the predecessor ran on the same machine
+    uint64_t peakMemoryBytes = 0;   ///< Peak resident memory of the process at the end of the last phase
+
+    /**
+     * Clears all counters and timers.
+     */
+    void reset() {
+        *this = ScheduleStats();
+    }
+
+    /**
+     * @return Average number of machines evaluated per job placed
+     */
+    double getMachinesEvaluatedPerJob() const {
+        return jobsPlaced > 0 ? static_cast<double>(machinesEvaluated) / jobsPlaced : 0.0;
+    }
+
+    /**
+     * Records the peak resident memory of the process so far.
+     */
+    void samplePeakMemory() {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            peakMemoryBytes = static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // kilobytes on Linux
+        }
+    }
+
+    /**
+     * @return The statistics as a JSON object, times in seconds
+     */
+    std::string toJson() const {
+        char json[640];
+        std::snprintf(json, sizeof(json),
+                      "{\"enabled\":%s,\"phaseSeconds\":{\"rank\":%.9f,\"sort\":%.9f,\"place\":%.9f},"
+                      "\"heapPushes\":%llu,\"heapPops\":%llu,\"jobsPlaced\":%llu,\"machinesEvaluated\":%llu,"
+                      "\"machinesEvaluatedPerJob\":%.6f,\"commSkips\":%llu,\"peakMemoryBytes\":%llu}",
+                      isEnabled ? "true" : "false", rankNanoseconds * 1e-9, sortNanoseconds * 1e-9, placeNanoseconds * 1e-9,
+                      static_cast<unsigned long long>(heapPushes), static_cast<unsigned long long>(heapPops),
+                      static_cast<unsigned long long>(jobsPlaced), static_cast<unsigned long long>(machinesEvaluated),
+                      getMachinesEvaluatedPerJob(), static_cast<unsigned long long>(commSkips),
+                      static_cast<unsigned long long>(peakMemoryBytes));
+        return json;
+    }
+
+    /**
+     * @param prefix Prefix of the metric names
+     * @return The statistics in the Prometheus text exposition format, times in seconds
+     */
+    std::string toPrometheus(const std::string& prefix = "workflow_schedule") const {
+        std::string text;
+        char line[256];
+        auto metric = [&](const char* name, const char* type, const char* help) {
+            text += "# HELP " + prefix + "_" + name + " " + help + "\n# TYPE " + prefix + "_" + name + " " + type + "\n";
+        };
+        auto value = [&](const char* name, const char* labels, double number) {
+            std::snprintf(line, sizeof(line), "%s_%s%s %.9g\n", prefix.c_str(), name, labels, number);
+            text += line;
+        };
+
+        metric("phase_seconds_total", "counter", "Time spent in each scheduling phase.");
+        value("phase_seconds_total", "{phase=\"rank\"}", rankNanoseconds * 1e-9);
+        value("phase_seconds_total", "{phase=\"sort\"}", sortNanoseconds * 1e-9);
+        value("phase_seconds_total", "{phase=\"place\"}", placeNanoseconds * 1e-9);
+        metric("heap_pushes_total", "counter", "Jobs pushed into ready heaps.");
+        value("heap_pushes_total", "", heapPushes);
+        metric("heap_pops_total", "counter", "Jobs popped from ready heaps.");
+        value("heap_pops_total", "", heapPops);
+        metric("jobs_placed_total", "counter", "Jobs placed on a machine.");
+        value("jobs_placed_total", "", jobsPlaced);
+        metric("machines_evaluated_total", "counter", "Machines evaluated to place or rank jobs.");
+        value("machines_evaluated_total", "", machinesEvaluated);
+        metric("comm_skips_total", "counter", "Communications skipped since the predecessor ran on the same machine.");
+        value("comm_skips_total", "", commSkips);
+        metric("peak_memory_bytes", "gauge", "Peak resident memory of the process.");
+        value("peak_memory_bytes", "", peakMemoryBytes);
+        return text;
+    }
+};
+
+/**
+ * @return Statistics of the calling thread
+ */
+inline ScheduleStats& getScheduleStats() {
+    static thread_local ScheduleStats stats;
+    return stats;
+}
+
+/**
+ * Adds the time from its construction to its destruction to a phase timer of the calling thread, and samples the
+ * peak memory at the end of the phase.
+ */
+class ScopedPhaseTimer {
+private:
+    uint64_t& nanoseconds;  ///< Timer of the phase
+    std::chrono::steady_clock::time_point start;    ///< When the phase started
+public:
+    explicit ScopedPhaseTimer(uint64_t& _nanoseconds): nanoseconds(_nanoseconds), start(std::chrono::steady_clock::now()) {}
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+    ~ScopedPhaseTimer() {
+        nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        getScheduleStats().samplePeakMemory();
+    }
+};
+
+#ifdef WORKFLOW_STATS
+// Adds to a counter of ScheduleStats.
+#define WORKFLOW_STATS_ADD(counter, amount) (getScheduleStats().counter += (amount))
+// Times the rest of the enclosing scope as a phase of ScheduleStats, rank, sort or place.
+#define WORKFLOW_STATS_PHASE(phase) ScopedPhaseTimer phaseTimer_(getScheduleStats().phase##Nanoseconds)
+#else
+#define WORKFLOW_STATS_ADD(counter, amount) ((void) 0)
+#define WORKFLOW_STATS_PHASE(phase) ((void) 0)
+#endif
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * Interning table mapping strings to dense 32-bit ids.
+ * All strings are stored null-terminated in one contiguous character buffer, and the lookup index is an
+ * open-addressing hash table of ids, so every distinct string is copied and stored exactly once.
+ */
+class StringTable {
+private:
+    enum : uint32_t { EMPTY_SLOT = 0xFFFFFFFFu };  ///< Marker for unused hash table slots
+
+    std::vector<char> buffer;        ///< Characters of all strings, each followed by a null terminator
+    std::vector<uint32_t> offsets;   ///< Start of each string in buffer indexed by id, plus the end of the buffer
+    std::vector<uint32_t> hashes;    ///< Hash of each string indexed by id, used to skip most string comparisons
+    std::vector<uint32_t> slots;     ///< Open-addressing hash table of ids, its size is a power of two
+
+    /**
+     * FNV-1a hash of a string.
+     * @param str Characters of the string
+     * @param length Length of the string
+     * @return 32-bit hash of the string
+     */
+    static uint32_t hash(const char* str, size_t length) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < length; i++) {
+            h = (h ^ static_cast<unsigned char>(str[i])) * 16777619u;
+        }
+        return h;
+    }
+
+    /**
+     * Finds the slot holding a string, or the empty slot where it would be inserted.
+     * @param str Characters of the string
+     * @param length Length of the string
+     * @param h Hash of the string
+     * @return Index of the slot
+     */
+    size_t findSlot(const char* str, size_t length, uint32_t h) const {
+        size_t mask = slots.size() - 1;
+        for (size_t slot = h & mask; ; slot = (slot + 1) & mask) {
+            uint32_t id = slots[slot];
+            if (id == EMPTY_SLOT) {
+                return slot;
+            }
+            if (hashes[id] == h && getLength(id) == length && std::memcmp(get(id), str, length) == 0) {
+                return slot;
+            }
+        }
+    }
+
+    /**
+     * Rebuilds the hash table with the given number of slots.
+     * @param numSlots New number of slots, a power of two
+     */
+    void rehash(size_t numSlots) {
+        slots.assign(numSlots, EMPTY_SLOT);
+        size_t mask = numSlots - 1;
+        for (uint32_t id = 0; id < size(); id++) {
+            size_t slot = hashes[id] & mask;
+            while (slots[slot] != EMPTY_SLOT) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = id;
+        }
+    }
+public:
+    /**
+     * Constructs an empty table.
+     */
+    StringTable(): offsets(1, 0), slots(16, EMPTY_SLOT) {}
+
+    /**
+     * Preallocates storage so that adding strings up to the given totals causes no reallocation.
+     * @param numStrings Expected number of distinct strings
+     * @param numChars Expected total number of characters, excluding null terminators
+     */
+    void reserve(size_t numStrings, size_t numChars) {
+        buffer.reserve(numChars + numStrings);
+        offsets.reserve(numStrings + 1);
+        hashes.reserve(numStrings);
+        size_t numSlots = slots.size();
+        while (numSlots < 2 * numStrings) {
+            numSlots *= 2;
+        }
+        if (numSlots != slots.size()) {
+            rehash(numSlots);
+        }
+    }
+
+    /**
+     * Returns the id of a string, adding it to the table if it is not present yet.
+     * @param str Characters of the string
+     * @param length Length of the string
+     * @param isNew Set to whether the string was added by this call
+     * @return Id of the string
+     */
+    uint32_t intern(const char* str, size_t length, bool& isNew) {
+        uint32_t h = hash(str, length);
+        size_t slot = findSlot(str, length, h);
+        isNew = slots[slot] == EMPTY_SLOT;
+        if (!isNew) {
+            return slots[slot];
+        }
+
+        uint32_t id = size();
+        buffer.insert(buffer.end(), str, str + length);
+        buffer.emplace_back('\0');
+        offsets.emplace_back(buffer.size());
+        hashes.emplace_back(h);
+        slots[slot] = id;
+
+        // keep the load factor at most one half
+        if (2 * size() > slots.size()) {
+            rehash(2 * slots.size());
+        }
+        return id;
+    }
+
+    /**
+     * Returns the id of a string, adding it to the table if it is not present yet.
+     * @param str The string
+     * @return Id of the string
+     */
+    uint32_t intern(const std::string& str) {
+        bool isNew;
+        return intern(str.data(), str.size(), isNew);
+    }
+
+    /**
+     * Looks up a string without adding it.
+     * @param str Characters of the string
+     * @param length Length of the string
+     * @param id Set to the id of the string if it is present
+     * @return True if the string is present, false otherwise
+     */
+    bool find(const char* str, size_t length, uint32_t& id) const {
+        size_t slot = findSlot(str, length, hash(str, length));
+        id = slots[slot];
+        return id != EMPTY_SLOT;
+    }
+
+    /**
+     * @param id Id of the string
+     * @return Pointer to the null-terminated string, valid until the next string is added
+     */
+    const char* get(uint32_t id) const {
+        return buffer.data() + offsets[id];
+    }
+
+    /**
+     * @param id Id of the string
+     * @return Length of the string
+     */
+    size_t getLength(uint32_t id) const {
+        return offsets[id + 1] - offsets[id] - 1;
+    }
+
+    /**
+     * @return Number of distinct strings in the table
+     */
+    uint32_t size() const {
+        return hashes.size();
+    }
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed-size pool of worker threads running one task at a time on all threads.
+ * The calling thread takes part as thread 0, so a pool of one thread runs everything inline.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;           ///< Worker threads 1 ... numThreads - 1
+    std::mutex mutex;                           ///< Guards the fields below
+    std::condition_variable taskReady;          ///< Signals workers that a new task or shutdown is pending
+    std::condition_variable taskDone;           ///< Signals the caller that all workers finished the task
+    const std::function<void(int)>* task = nullptr;  ///< Task of the current round
+    unsigned long generation = 0;               ///< Incremented for every new task
+    int running = 0;                            ///< Number of workers still running the current task
+    bool stopping = false;                      ///< Set when the pool is destroyed
+
+    /**
+     * Main loop of a worker thread.
+     * @param thread Index of the worker
+     */
+    void work(int thread) {
+        unsigned long seenGeneration = 0;
+        while (true) {
+            const std::function<void(int)>* currentTask;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                taskReady.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if (stopping) {
+                    return;
+                }
+                seenGeneration = generation;
+                currentTask = task;
+            }
+
+            (*currentTask)(thread);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0) {
+                taskDone.notify_one();
+            }
+        }
+    }
+public:
+    /**
+     * Constructor for ThreadPool.
+     * @param numThreads Number of threads including the calling one, hardware concurrency if not positive
+     */
+    explicit ThreadPool(int numThreads = 0) {
+        if (numThreads <= 0) {
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (int thread = 1; thread < numThreads; thread++) {
+            workers.emplace_back(&ThreadPool::work, this, thread);
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Destructor for ThreadPool.
+     * Stops and joins all worker threads.
+     */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (auto& worker: workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @return Number of threads including the calling one
+     */
+    int getNumThreads() const {
+        return workers.size() + 1;
+    }
+
+    /**
+     * Runs a task on every thread of the pool and waits until all of them finish.
+     * @param body Task, called with the index of the thread running it
+     */
+    void run(const std::function<void(int)>& body) {
+        if (workers.empty()) {
+            body(0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &body;
+            running = workers.size();
+            generation++;
+        }
+        taskReady.notify_all();
+
+        body(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        taskDone.wait(lock, [&] { return running == 0; });
+    }
+
+    /**
+     * Runs a loop body for every index in a range, handing out chunks of indices to the threads dynamically.
+     * @param begin First index
+     * @param end One past the last index
+     * @param chunkSize Number of consecutive indices taken by a thread at a time
+     * @param body Loop body, called with the index and the index of the thread running it
+     */
+    template <class Body>
+    void parallelFor(size_t begin, size_t end, size_t chunkSize, const Body& body) {
+        std::atomic<size_t> next(begin);
+        run([&](int thread) {
+            while (true) {
+                size_t chunkBegin = next.fetch_add(chunkSize, std::memory_order_relaxed);
+                if (chunkBegin >= end) {
+                    break;
+                }
+                size_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+                for (size_t i = chunkBegin; i < chunkEnd; i++) {
+                    body(i, thread);
+                }
+            }
+        });
+    }
+
+    /**
+     * Sorts a vector by splitting it into one run per thread, sorting the runs concurrently and merging them pairwise.
+     * Vectors too small to be worth splitting are sorted on the calling thread.
+     * @param items Items to sort
+     * @param comp Strict weak ordering of the items
+     */
+    template <class T, class Compare>
+    void parallelSort(std::vector<T>& items, const Compare& comp) {
+        const size_t MIN_RUN_SIZE = 1 << 14;
+        size_t numRuns = std::min<size_t>(getNumThreads(), items.size() / MIN_RUN_SIZE);
+        if (numRuns <= 1) {
+            std::sort(items.begin(), items.end(), comp);
+            return;
+        }
+
+        std::vector<size_t> bounds(numRuns + 1);
+        for (size_t part = 0; part <= numRuns; part++) {
+            bounds[part] = items.size() * part / numRuns;
+        }
+        parallelFor(0, numRuns, 1, [&](size_t part, int) {
+            std::sort(items.begin() + bounds[part], items.begin() + bounds[part + 1], comp);
+        });
+
+        // merge neighbouring runs into the buffer, doubling the run width every round
+        std::vector<T> buffer(items.size());
+        for (size_t width = 1; width < numRuns; width *= 2) {
+            parallelFor(0, (numRuns + 2 * width - 1) / (2 * width), 1, [&](size_t pair, int) {
+                size_t first = 2 * width * pair;
+                size_t middle = std::min(first + width, numRuns);
+                size_t last = std::min(first + 2 * width, numRuns);
+                std::merge(items.begin() + bounds[first], items.begin() + bounds[middle],
+                           items.begin() + bounds[middle], items.begin() + bounds[last],
+                           buffer.begin() + bounds[first], comp);
+            });
+            items.swap(buffer);
+        }
+    }
+};
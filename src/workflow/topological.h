@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "csr.h"
+#include "ready_queue.h"
+#include "thread_pool.h"
+
+/**
+ * Calculates the level of every job, i.e. the number of jobs on the longest path from an entry job to it.
+ * The graph is peeled frontier by frontier: every job of a frontier is visited concurrently and atomically decrements
+ * the indegree of its successors, and a successor whose indegree drops to zero joins the next frontier through the
+ * buffer of the thread that released it. Frontiers too small to be worth distributing are visited on the calling thread.
+ * @param graph Frozen workflow graph
+ * @param pool Threads to use
+ * @return Vector of levels indexed by job id, UINT32_MAX for jobs on or behind a cycle
+ */
+inline std::vector<uint32_t> computeTopologicalLevels(const CSRWorkflowGraph& graph, ThreadPool& pool) {
+    const size_t MIN_PARALLEL_LEVEL = 4096;  // smaller frontiers don't amortize the barrier
+    const size_t CHUNK_SIZE = 256;
+    size_t numJobs = graph.getNumJobs();
+    int numThreads = pool.getNumThreads();
+    std::vector<uint32_t> levels(numJobs, UINT32_MAX);
+    std::vector<std::atomic<int>> inDegrees(numJobs);
+    std::vector<std::vector<JobId>> threadFrontiers(numThreads);
+
+    // initialize the indegrees and collect the entry jobs as the first frontier
+    pool.parallelFor(0, numJobs, 4 * CHUNK_SIZE, [&](size_t job, int thread) {
+        int inDegree = graph.getIndegree(job);
+        inDegrees[job].store(inDegree, std::memory_order_relaxed);
+        if (inDegree == 0) {
+            threadFrontiers[thread].emplace_back(job);
+        }
+    });
+
+    std::vector<JobId> frontier;
+    for (auto& threadFrontier: threadFrontiers) {
+        frontier.insert(frontier.end(), threadFrontier.begin(), threadFrontier.end());
+        threadFrontier.clear();
+    }
+
+    auto visit = [&](JobId job, uint32_t level, std::vector<JobId>& nextFrontier) {
+        levels[job] = level;
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            if (inDegrees[comm.job].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                nextFrontier.emplace_back(comm.job);
+            }
+        }
+    };
+
+    std::vector<JobId> nextFrontier;
+    for (uint32_t level = 0; !frontier.empty(); level++) {
+        if (numThreads == 1 || frontier.size() < MIN_PARALLEL_LEVEL) {
+            for (JobId job: frontier) {
+                visit(job, level, nextFrontier);
+            }
+        } else {
+            pool.parallelFor(0, frontier.size(), CHUNK_SIZE, [&](size_t i, int thread) {
+                visit(frontier[i], level, threadFrontiers[thread]);
+            });
+            for (auto& threadFrontier: threadFrontiers) {
+                nextFrontier.insert(nextFrontier.end(), threadFrontier.begin(), threadFrontier.end());
+                threadFrontier.clear();
+            }
+        }
+        frontier.swap(nextFrontier);
+        nextFrontier.clear();
+    }
+
+    return levels;
+}
+
+/**
+ * Checks whether a workflow has a cycle, with Kahn's algorithm counting the jobs that become ready.
+ * @param graph Frozen workflow graph
+ * @return True if every job becomes ready, false if some are on or behind a cycle
+ */
+inline bool isAcyclic(const CSRWorkflowGraph& graph) {
+    size_t numJobs = graph.getNumJobs();
+    std::vector<int> inDegrees(numJobs);
+    std::vector<JobId> ready;
+    for (JobId job = 0; job < numJobs; job++) {
+        inDegrees[job] = graph.getIndegree(job);
+        if (inDegrees[job] == 0) {
+            ready.emplace_back(job);
+        }
+    }
+    size_t numReady = ready.size();
+    while (!ready.empty()) {
+        JobId job = ready.back();
+        ready.pop_back();
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            if (--inDegrees[comm.job] == 0) {
+                ready.emplace_back(comm.job);
+                numReady++;
+            }
+        }
+    }
+    return numReady == numJobs;
+}
+
+/**
+ * Level-synchronous parallel topological sort.
+ * Jobs are ordered by decreasing critical weight, then by increasing level, then by increasing id. Along every
+ * communication the critical weight never increases and the level strictly increases, so this is always a valid
+ * topological order, and like the serial sort it favours the most critical jobs within and across levels.
+ * It is reproducible for any number of threads, but may differ from the serial order among jobs of equal weight.
+ * @param graph Frozen workflow graph
+ * @param criticalWeights Critical weight of every job indexed by job id
+ * @param pool Threads to use
+ * @return Vector of job ids representing the topological order, without the jobs on or behind a cycle
+ */
+inline std::vector<JobId> sortByLevelAndCriticality(const CSRWorkflowGraph& graph, const std::vector<int>& criticalWeights,
+                                                    ThreadPool& pool) {
+    std::vector<uint32_t> levels = computeTopologicalLevels(graph, pool);
+
+    // (descending key of the critical weight, level) packed so that a single comparison orders the first two keys
+    std::vector<std::pair<uint64_t, JobId>> keys;
+    keys.reserve(graph.getNumJobs());
+    for (JobId job = 0; job < graph.getNumJobs(); job++) {
+        if (levels[job] != UINT32_MAX) {
+            uint64_t inverseWeight = toDescendingKey(criticalWeights[job]);
+            keys.emplace_back(inverseWeight << 32 | levels[job], job);
+        }
+    }
+    pool.parallelSort(keys, [](const std::pair<uint64_t, JobId>& a, const std::pair<uint64_t, JobId>& b) {
+        return a < b;
+    });
+
+    std::vector<JobId> topOrder(keys.size());
+    pool.parallelFor(0, keys.size(), 4096, [&](size_t i, int) {
+        topOrder[i] = keys[i].second;
+    });
+    return topOrder;
+}
+
+/**
+ * Checks in parallel whether ordering all jobs by decreasing critical weight and then by increasing id is a valid
+ * topological order, i.e. whether every communication leads to a less critical job or to an equally critical job
+ * with a larger id. It always is when all execution times are positive.
+ * Kahn's sort always pops the job that comes first in its priority order among the ready ones, so whenever this
+ * holds, its result is exactly the jobs sorted by priority.
+ * @param graph Frozen workflow graph
+ * @param criticalWeights Critical weight of every job indexed by job id
+ * @param pool Threads to use
+ * @return True if the priority order is a topological order, false otherwise
+ */
+inline bool isCriticalityOrderTopological(const CSRWorkflowGraph& graph, const std::vector<int>& criticalWeights,
+                                          ThreadPool& pool) {
+    std::atomic<bool> isTopological(true);
+    pool.parallelFor(0, graph.getNumJobs(), 1024, [&](size_t job, int) {
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            int weight = criticalWeights[job], successorWeight = criticalWeights[comm.job];
+            if (weight < successorWeight || (weight == successorWeight && job > comm.job)) {
+                isTopological.store(false, std::memory_order_relaxed);
+            }
+        }
+    });
+    return isTopological.load();
+}
+
+/**
+ * Sorts all jobs in parallel by decreasing critical weight, and by increasing id among equal weights.
+ * @param criticalWeights Critical weight of every job indexed by job id
+ * @param pool Threads to use
+ * @return Vector of job ids in priority order
+ */
+inline std::vector<JobId> sortByCriticality(const std::vector<int>& criticalWeights, ThreadPool& pool) {
+    // (descending key of the critical weight, id) packed so that a single comparison orders the jobs
+    std::vector<uint64_t> keys(criticalWeights.size());
+    pool.parallelFor(0, keys.size(), 4096, [&](size_t job, int) {
+        uint64_t inverseWeight = toDescendingKey(criticalWeights[job]);
+        keys[job] = inverseWeight << 32 | job;
+    });
+    pool.parallelSort(keys, [](uint64_t a, uint64_t b) {
+        return a < b;
+    });
+
+    std::vector<JobId> order(keys.size());
+    pool.parallelFor(0, keys.size(), 4096, [&](size_t i, int) {
+        order[i] = static_cast<JobId>(keys[i]);
+    });
+    return order;
+}
@@ -0,0 +1,264 @@
+/*
+Checks the content hash of workflows and the schedule cache. The hash must not
+depend on the order in which jobs and communications are added, and undoing a
+change must restore it. A schedule cached for a workflow must be found for the
+same workflow built in another order, with the ids of that workflow, and the
+least recently used schedule must be evicted first. A schedule whose jobs
+don't match the workflow, as after a hash collision, must be evicted instead of
+returned. Schedules written to disk must be read back identical by another
+cache, and truncated or corrupt schedule files must be rejected.
+
+Usage: cache_test [number of workflows]   (default: 300)
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "reference.h"
+
+/**
+ * Adds a random workflow to an empty graph, with its jobs and communications added in a random order.
+ * @param workflow Jobs and communications of the workflow
+ * @param rng Random generator, or null to add them in order
+ * @param graph Empty workflow graph
+ */
+static void buildWorkflow(const RandomWorkflow& workflow, std::mt19937* rng, WorkflowGraph& graph) {
+    std::vector<size_t> jobs(workflow.executionTimes.size()), comms(workflow.commTimes.size());
+    for (size_t i = 0; i < jobs.size(); i++) {
+        jobs[i] = i;
+    }
+    for (size_t i = 0; i < comms.size(); i++) {
+        comms[i] = i;
+    }
+    if (rng != nullptr) {
+        std::shuffle(jobs.begin(), jobs.end(), *rng);
+        std::shuffle(comms.begin(), comms.end(), *rng);
+    }
+    for (size_t job: jobs) {
+        graph.addJob("job" + std::to_string(job), workflow.executionTimes[job]);
+    }
+    for (size_t i: comms) {
+        graph.addCommunication("job" + std::to_string(workflow.fromJobs[i]), "job" + std::to_string(workflow.toJobs[i]),
+                               workflow.commTimes[i]);
+    }
+}
+
+/**
+ * Reports a failed check on the standard error.
+ * @param context Description of the case
+ * @param isOk Result of the check
+ * @param message What went wrong if the check failed
+ * @return 0 if the check passed, 1 otherwise
+ */
+static int check(const std::string& context, bool isOk, const char* message) {
+    if (!isOk) {
+        std::fprintf(stderr, "%s: %s\n", context.c_str(), message);
+    }
+    return !isOk;
+}
+
+/**
+ * @param graph The workflow
+ * @param numMachines Number of machines
+ * @return Key of the schedule of the workflow on that many machines with the default policies
+ */
+static ScheduleCacheKey makeKey(const WorkflowGraph& graph, int numMachines) {
+    return {graph.getContentHash(), numMachines, PlacementPolicy::Append, OrderingPolicy::StaticCriticalPath};
+}
+
+/**
+ * Checks that the hash doesn't depend on the order of construction and comes back after undoing changes, and that a
+ * cached schedule applies to the same workflow built in another order.
+ * @param seed Index of the workflow
+ * @param rng Random generator
+ * @return Number of failed checks
+ */
+static int checkHash(int seed, std::mt19937& rng) {
+    std::string context = "workflow " + std::to_string(seed);
+    RandomWorkflow workflow = generateRandomWorkflow(rng);
+    WorkflowGraph graph, shuffled;
+    buildWorkflow(workflow, nullptr, graph);
+    buildWorkflow(workflow, &rng, shuffled);
+    GraphHash hash = graph.getContentHash();
+    int numFailures = check(context, shuffled.getContentHash() == hash, "hash depends on the order of construction");
+
+    JobId job = rng() % graph.getNumJobs();
+    int executionTime = graph.getJob(job)->executionTime;
+    graph.setExecutionTime(job, executionTime + 1);
+    numFailures += check(context, graph.getContentHash() != hash, "hash ignores an execution time");
+    graph.setExecutionTime(job, executionTime);
+    numFailures += check(context, graph.getContentHash() == hash, "hash not restored after undoing an execution time");
+
+    if (!workflow.commTimes.empty()) {
+        size_t i = rng() % workflow.commTimes.size();
+        JobId from = workflow.fromJobs[i], to = workflow.toJobs[i];
+        std::vector<int> commTimes;
+        for (size_t j = 0; j < workflow.commTimes.size(); j++) {
+            if (workflow.fromJobs[j] == from && workflow.toJobs[j] == to) {
+                commTimes.emplace_back(workflow.commTimes[j]);
+            }
+        }
+        graph.removeCommunication(from, to);
+        numFailures += check(context, graph.getContentHash() != hash, "hash ignores a communication");
+        for (int commTime: commTimes) {
+            graph.addCommunication(from, to, commTime);
+        }
+        numFailures += check(context, graph.getContentHash() == hash, "hash not restored after adding communications back");
+    }
+
+    // a schedule of the workflow applies to the shuffled one, job by job through the names
+    ScheduleCache cache;
+    int numMachines = 1 + rng() % 4;
+    WorkflowSchedule schedule(&graph, numMachines);
+    schedule.setScheduleCache(&cache);
+    std::pair<int, ScheduleOrder> expected = schedule.schedule(), found;
+    if (!cache.find(makeKey(shuffled, numMachines), shuffled, found) || found.first != expected.first ||
+        found.second.size() != expected.second.size()) {
+        return numFailures + check(context, false, "cached schedule not found for the shuffled workflow");
+    }
+    for (size_t i = 0; i < expected.second.size(); i++) {
+        const ScheduledJob& e = expected.second[i];
+        const ScheduledJob& a = found.second[i];
+        if (std::string(graph.getJobName(e.jobId)) != shuffled.getJobName(a.jobId) || e.machineId != a.machineId ||
+            e.startTime != a.startTime || e.finishTime != a.finishTime) {
+            return numFailures + check(context, false, "cached schedule translated to the wrong jobs");
+        }
+    }
+    return numFailures;
+}
+
+/**
+ * Checks the least recently used eviction and the eviction of schedules that don't match the workflow.
+ * @return Number of failed checks
+ */
+static int checkEviction() {
+    std::mt19937 rng(18);
+    RandomWorkflow workflow = generateRandomWorkflow(rng);
+    WorkflowGraph graph;
+    buildWorkflow(workflow, nullptr, graph);
+    ScheduleCache cache(3);
+    std::pair<int, ScheduleOrder> result;
+    for (int numMachines = 1; numMachines <= 4; numMachines++) {
+        WorkflowSchedule schedule(&graph, numMachines);
+        cache.insert(makeKey(graph, numMachines), graph, {numMachines, schedule.computeSchedule().second});
+    }
+    int numFailures = check("eviction", cache.size() == 3, "cache holds more schedules than its capacity");
+    numFailures += check("eviction", !cache.find(makeKey(graph, 1), graph, result), "least recently used schedule kept");
+
+    // using the schedule for 2 machines makes the one for 3 machines the least recently used
+    numFailures += check("eviction", cache.find(makeKey(graph, 2), graph, result) && result.first == 2,
+                         "recent schedule not found");
+    WorkflowSchedule schedule(&graph, 5);
+    cache.insert(makeKey(graph, 5), graph, schedule.computeSchedule());
+    numFailures += check("eviction", !cache.find(makeKey(graph, 3), graph, result), "schedule evicted out of order");
+    numFailures += check("eviction", cache.find(makeKey(graph, 2), graph, result) && cache.find(makeKey(graph, 4), graph, result) &&
+                                     cache.find(makeKey(graph, 5), graph, result),
+                         "recently used schedule evicted");
+    numFailures += check("eviction", cache.getNumHits() == 4 && cache.getNumMisses() == 2, "wrong hit and miss counts");
+
+    // a workflow colliding with the cached one, whose jobs have other names or another number of jobs
+    WorkflowGraph renamed, smaller;
+    for (JobId job = 0; job < graph.getNumJobs(); job++) {
+        renamed.addJob("other" + std::to_string(job), graph.getJob(job)->executionTime);
+    }
+    smaller.addJob("job0", 1);
+    ScheduleCacheKey key = makeKey(graph, 4);
+    numFailures += check("collision", !cache.find(key, renamed, result), "schedule returned for other job names");
+    numFailures += check("collision", cache.size() == 2, "schedule for other job names not evicted");
+    numFailures += check("collision", !cache.find(key, graph, result), "evicted schedule still found");
+    key = makeKey(graph, 5);
+    numFailures += check("collision", !cache.find(key, smaller, result) && cache.size() == 1,
+                         "schedule for another number of jobs not evicted");
+    return numFailures;
+}
+
+/**
+ * Writes a schedule file with the given bytes.
+ * @param path Path of the file
+ * @param bytes Content of the file
+ */
+static void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+}
+
+/**
+ * Checks that schedules written to disk are read back identical, and that truncated and corrupt files are rejected.
+ * @return Number of failed checks
+ */
+static int checkDisk() {
+    char directory[] = "/tmp/cache_test.XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        return check("disk", false, "cannot create a temporary directory");
+    }
+
+    std::mt19937 rng(181);
+    RandomWorkflow workflow = generateRandomWorkflow(rng);
+    WorkflowGraph graph, shuffled;
+    buildWorkflow(workflow, nullptr, graph);
+    buildWorkflow(workflow, &rng, shuffled);
+    ScheduleCacheKey key = {graph.getContentHash(), 3, PlacementPolicy::Insertion, OrderingPolicy::StaticCriticalPath};
+    WorkflowSchedule schedule(&graph, 3);
+    schedule.setPlacementPolicy(PlacementPolicy::Insertion);
+    std::pair<int, ScheduleOrder> expected = schedule.computeSchedule(), result;
+    ScheduleCache(1, directory).insert(key, graph, expected);
+
+    // another cache reads the file, for the workflow itself and for the same workflow built in another order
+    int numFailures = check("disk", ScheduleCache(1, directory).find(key, graph, result) &&
+                                    checkSameSchedule("disk", expected, result),
+                            "schedule not read back identical");
+    numFailures += check("disk", ScheduleCache(1, directory).find(key, shuffled, result) && result.first == expected.first,
+                         "schedule not read back for the shuffled workflow");
+
+    std::string path = std::string(directory) + "/" + key.getFileName(), bytes;
+    {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    for (size_t length = 0; length < bytes.size(); length += 1 + length / 8) {
+        writeFile(path, bytes.substr(0, length));
+        numFailures += check("disk, truncated to " + std::to_string(length) + " bytes",
+                             !ScheduleCache(1, directory).find(key, graph, result), "truncated file accepted");
+    }
+
+    std::vector<std::pair<std::string, std::string>> corruptions;
+    corruptions.emplace_back("bad magic", "X" + bytes.substr(1));
+    corruptions.emplace_back("trailing bytes", bytes + "junk");
+    std::string otherCount = bytes, hugeName = bytes;
+    otherCount[8]++;
+    hugeName[12] = hugeName[13] = hugeName[14] = hugeName[15] = '\xff';
+    corruptions.emplace_back("other number of jobs", otherCount);
+    corruptions.emplace_back("huge name length", hugeName);
+    for (const auto& corruption: corruptions) {
+        writeFile(path, corruption.second);
+        numFailures += check("disk, " + corruption.first, !ScheduleCache(1, directory).find(key, graph, result),
+                             "corrupt file accepted");
+    }
+
+    writeFile(path, bytes);
+    numFailures += check("disk", ScheduleCache(1, directory).find(key, graph, result), "restored file rejected");
+    std::remove(path.c_str());
+    rmdir(directory);
+    return numFailures;
+}
+
+int main(int argc, char** argv) {
+    int numWorkflows = argc > 1 ? std::atoi(argv[1]) : 300;
+
+    std::mt19937 rng(18);
+    int numFailures = 0;
+    for (int seed = 0; seed < numWorkflows; seed++) {
+        numFailures += checkHash(seed, rng);
+    }
+    numFailures += checkEviction();
+    numFailures += checkDisk();
+
+    std::printf("cache_test: %d workflows, %d failures\n", numWorkflows, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,101 @@
+/*
+Checks that the scheduler program rejects a workflow with a cycle without
+writing any schedule, with every ordering policy and output format, to a file
+or to the standard output, and with the phases timed or not. Jobs ahead of the
+cycle can be placed, so a program checking for cycles only after placing would
+have streamed them out already. The same workflow without the cycle must be
+scheduled and written.
+
+Usage: cli_test [path of the program]   (default: build/main)
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Runs the program on a workflow file.
+ * @param program Path of the program
+ * @param arguments Options of the program
+ * @param inputPath Path of the workflow file
+ * @param outputPath File receiving the standard output
+ * @return Exit status of the program, or -1 if it didn't exit normally
+ */
+static int runProgram(const std::string& program, const std::string& arguments, const std::string& inputPath,
+                      const std::string& outputPath) {
+    std::string command = program + " " + arguments + " " + inputPath + " > " + outputPath + " 2>/dev/null";
+    int status = std::system(command.c_str());
+    return status != -1 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * @param path Path of a file
+ * @return Size of the file, or -1 if it doesn't exist
+ */
+static long getFileSize(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+    return in ? static_cast<long>(in.tellg()) : -1;
+}
+
+int main(int argc, char** argv) {
+    std::string program = argc > 1 ? argv[1] : "build/main";
+    char directory[] = "/tmp/cli_test.XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        std::fprintf(stderr, "cannot create a temporary directory\n");
+        return EXIT_FAILURE;
+    }
+    std::string cyclicPath = std::string(directory) + "/cyclic.txt", acyclicPath = std::string(directory) + "/acyclic.txt";
+    std::string schedulePath = std::string(directory) + "/schedule", stdoutPath = std::string(directory) + "/stdout";
+    {
+        // a and e are ready at once, d is behind the cycle of b and c
+        std::ofstream cyclic(cyclicPath.c_str()), acyclic(acyclicPath.c_str());
+        const char* workflow = "a,1\nb,2\nc,3\nd,4\ne,5\na,b,1\nb,c,1\nc,d,1\ne,d,2\n";
+        cyclic << workflow << "c,b,1\n";
+        acyclic << workflow;
+    }
+
+    const char* const orderings[] = {"static", "dls", "etf"};
+    const char* const formats[] = {"text", "csv", "json", "trace", "binary"};
+    int numRuns = 0, numFailures = 0;
+    for (const char* ordering: orderings) {
+        for (const char* format: formats) {
+            for (int variant = 0; variant < 3; variant++) {
+                // to the standard output, to a file, and to a file with the phases timed
+                std::string arguments = std::string("-r ") + ordering + " -w " + format;
+                if (variant > 0) {
+                    arguments += " -o " + schedulePath + (variant == 2 ? " -T" : "");
+                }
+                std::string context = arguments;
+                std::remove(schedulePath.c_str());
+                int status = runProgram(program, arguments, cyclicPath, stdoutPath);
+                long outputSize = variant > 0 ? getFileSize(schedulePath) : getFileSize(stdoutPath);
+                if (status != 1 || outputSize > 0 || getFileSize(stdoutPath) != 0) {
+                    std::fprintf(stderr, "%s, cyclic: exit status %d and %ld bytes written\n", context.c_str(), status,
+                                 outputSize);
+                    numFailures++;
+                }
+
+                std::remove(schedulePath.c_str());
+                status = runProgram(program, arguments, acyclicPath, stdoutPath);
+                outputSize = variant > 0 ? getFileSize(schedulePath) : getFileSize(stdoutPath);
+                if (status != 0 || outputSize <= 0) {
+                    std::fprintf(stderr, "%s, acyclic: exit status %d and %ld bytes written\n", context.c_str(), status,
+                                 outputSize);
+                    numFailures++;
+                }
+                numRuns += 2;
+            }
+        }
+    }
+
+    std::remove(cyclicPath.c_str());
+    std::remove(acyclicPath.c_str());
+    std::remove(schedulePath.c_str());
+    std::remove(stdoutPath.c_str());
+    rmdir(directory);
+    std::printf("cli_test: %d runs, %d failures\n", numRuns, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
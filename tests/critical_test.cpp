@@ -0,0 +1,74 @@
+/*
+Checks the level-synchronous parallel critical weights against the serial
+sweep, on 1, 2 and many threads. The synthetic DAG families of the benchmarks
+are large enough for the Montage and FFT ones to have levels distributed over
+the threads, and small random workflows with jobs of zero length cover the
+levels evaluated on the calling thread.
+
+Usage: critical_test [number of random workflows]   (default: 500)
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../bench/generators.h"
+#include "reference.h"
+
+/**
+ * Compares the parallel critical weights of a workflow with the serial ones on every pool.
+ * @param context Description of the case, printed with a difference
+ * @param graph The workflow
+ * @param pools Thread pools to compute the parallel critical weights with
+ * @return Number of pools giving other critical weights than the serial sweep
+ */
+static int checkCriticalWeights(const std::string& context, const CSRWorkflowGraph& graph,
+                                std::vector<ThreadPool*>& pools) {
+    std::vector<int> expected = computeCriticalWeights(graph);
+    int numFailures = 0;
+    for (ThreadPool* pool: pools) {
+        std::vector<int> actual = computeCriticalWeights(graph, *pool);
+        auto mismatch = std::mismatch(expected.begin(), expected.end(), actual.begin());
+        if (actual.size() != expected.size() || mismatch.first != expected.end()) {
+            size_t job = mismatch.first - expected.begin();
+            std::fprintf(stderr, "%s, %d threads: critical weight of job %zu is %d, expected %d\n", context.c_str(),
+                         pool->getNumThreads(), job, job < actual.size() ? actual[job] : -1,
+                         job < expected.size() ? expected[job] : -1);
+            numFailures++;
+        }
+    }
+    return numFailures;
+}
+
+int main(int argc, char** argv) {
+    int numWorkflows = argc > 1 ? std::atoi(argv[1]) : 500;
+    ThreadPool onePool(1), twoPool(2), manyPool(std::max(4u, std::thread::hardware_concurrency()));
+    std::vector<ThreadPool*> pools = {&onePool, &twoPool, &manyPool};
+
+    int numChecked = 0, numFailures = 0;
+    const double ccrs[] = {0.1, 1, 10};
+    for (size_t family = 0; family < sizeof(GRAPH_FAMILY_NAMES) / sizeof(GRAPH_FAMILY_NAMES[0]); family++) {
+        for (uint32_t seed = 1; seed <= 3; seed++) {
+            GeneratorOptions options;
+            options.ccr = ccrs[seed - 1];
+            options.seed = seed;
+            CSRWorkflowGraph graph = generateWorkflow(static_cast<GraphFamily>(family), options).freeze();
+            std::string context = std::string(GRAPH_FAMILY_NAMES[family]) + ", seed " + std::to_string(seed);
+            numFailures += checkCriticalWeights(context, graph, pools);
+            numChecked++;
+        }
+    }
+
+    std::mt19937 rng(12);
+    for (int seed = 0; seed < numWorkflows; seed++) {
+        CSRWorkflowGraph graph = generateRandomWorkflow(rng).freeze();
+        numFailures += checkCriticalWeights("workflow " + std::to_string(seed), graph, pools);
+        numChecked++;
+    }
+
+    std::printf("critical_test: %d workflows, %d failures\n", numChecked, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,45 @@
+/*
+Checks the dynamic list scheduler of WorkflowSchedule, with the DLS and ETF
+ordering policies and both placement policies, against
+referenceDynamicSchedule() on random DAGs. The reference evaluates every ready
+job on every machine after every placement, so the lazy queues and heaps of the
+scheduler must pick the same job at every step, ties included.
+
+Usage: dynamic_test [number of workflows]   (default: 2000)
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include "reference.h"
+
+int main(int argc, char** argv) {
+    int numWorkflows = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const OrderingPolicy orderings[] = {OrderingPolicy::DynamicLevel, OrderingPolicy::EarliestTimeFirst};
+    const char* orderingNames[] = {"dls", "etf"};
+    const PlacementPolicy placements[] = {PlacementPolicy::Append, PlacementPolicy::Insertion};
+    const char* placementNames[] = {"append", "insertion"};
+
+    std::mt19937 rng(15);
+    int numFailures = 0;
+    for (int seed = 0; seed < numWorkflows; seed++) {
+        CSRWorkflowGraph graph = generateRandomWorkflow(rng).freeze();
+        int numMachines = 1 + rng() % 6;
+        for (int o = 0; o < 2; o++) {
+            for (int p = 0; p < 2; p++) {
+                WorkflowSchedule schedule(&graph, numMachines);
+                schedule.setOrderingPolicy(orderings[o]);
+                schedule.setPlacementPolicy(placements[p]);
+                std::pair<int, ScheduleOrder> expected =
+                    referenceDynamicSchedule(graph, schedule.getCriticalWeights(), numMachines, placements[p], orderings[o]);
+                std::string context = "workflow " + std::to_string(seed) + ", " + std::to_string(numMachines) +
+                                      " machines, " + orderingNames[o] + ", " + placementNames[p];
+                numFailures += !checkSameSchedule(context, expected, schedule.schedule());
+            }
+        }
+    }
+
+    std::printf("dynamic_test: %d workflows, %d failures\n", numWorkflows, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
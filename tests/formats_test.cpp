@@ -0,0 +1,201 @@
+/*
+Checks the edge list, DOT, DAX and WfCommons readers on small files covering
+the syntax of each format: separators, quotes, comments and headers, chained
+edges, ports and subgraphs, XML entities, file sizes turned into communication
+times, both WfCommons schemas, string and null numbers, and JSON escapes
+including surrogate pairs. Malformed files must be rejected with an error
+naming what is wrong, and the line for the edge list.
+
+Usage: formats_test
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "reference.h"
+
+// A file to read, with either the workflow expected or a part of the error expected.
+struct FormatCase {
+    const char* name;           ///< Name of the case
+    WorkflowFormat format;      ///< Format of the file
+    const char* content;        ///< Content of the file
+    const char* expected;       ///< Jobs as "name=time" and communications as "from->to:time", sorted, or null
+    const char* error;          ///< Part of the error message expected if the file must be rejected, or null
+    double bandwidth;           ///< Bandwidth of the read options
+};
+
+static const FormatCase CASES[] = {
+    {"edge list", WorkflowFormat::EdgeList,
+     "job,time\n"
+     "# comment\n"
+     "a,3\n"
+     "\"b c\";4 # trailing comment\n"
+     "\n"
+     "c\t5\r\n"
+     "a,\"b c\",2\n"
+     "a c 7\n"
+     "c;d;1.5\n",
+     "a->b c:2 a->c:7 a=3 b c=4 c->d:2 c=5 d=0", nullptr, 0},
+    {"edge list, too many fields", WorkflowFormat::EdgeList, "a,1\nb,2\na,b,c,1\n", nullptr, ":3: Expected at most 3 fields", 0},
+    {"edge list, missing time", WorkflowFormat::EdgeList, "a,1\nb\n", nullptr, ":2: Expected a job and its execution time", 0},
+    {"edge list, not a number", WorkflowFormat::EdgeList, "a,1\nb,c,x\n", nullptr, ":2: Expected a job and its", 0},
+    {"edge list, negative time", WorkflowFormat::EdgeList, "a,-1\n", nullptr, ":1: Time is negative or too large", 0},
+    {"edge list, huge time", WorkflowFormat::EdgeList, "a,1\nb,1\na,b,3e10\n", nullptr, ":3: Time is negative or too large", 0},
+
+    {"DOT", WorkflowFormat::Dot,
+     "/* header */ strict digraph \"G\" {\n"
+     "  graph [rankdir=LR]; node [shape=box]; size=\"7,7\";\n"
+     "  a [weight=2];\n"
+     "  b [label=\"x -> y\", time=3]\n"
+     "  \"c d\" [runtime=4] [color=red];\n"
+     "# preprocessor line\n"
+     "  a -> b -> \"c d\" [comm=5]; // chain\n"
+     "  a:p:n -> c\n"
+     "  subgraph cluster { e [size=1]; }\n"
+     "}\n",
+     "a->b:5 a->c:0 a=2 b->c d:5 b=3 c d=4 c=0 e=1", nullptr, 0},
+    {"DOT, subgraph endpoint", WorkflowFormat::Dot, "digraph { a -> { b c } }", nullptr, "Subgraphs as edge endpoints", 0},
+    {"DOT, unterminated attributes", WorkflowFormat::Dot, "digraph { a [weight=1", nullptr, "Unterminated attribute list", 0},
+    {"DOT, missing value", WorkflowFormat::Dot, "digraph { a [weight=] }", nullptr, "Expected a value for attribute weight", 0},
+    {"DOT, negative time", WorkflowFormat::Dot, "digraph { a -> b [comm=-2] }", nullptr, "Time is negative or too large", 0},
+
+    {"DAX", WorkflowFormat::Dax,
+     "<?xml version=\"1.0\"?>\n"
+     "<!-- generated -->\n"
+     "<adag xmlns=\"http://pegasus.isi.edu/schema/DAX\">\n"
+     "  <job id=\"ID1\" name=\"one\" runtime=\"2\">\n"
+     "    <uses file=\"f1\" link=\"output\" size=\"100\"/>\n"
+     "    <uses file=\"f2\" link=\"output\" size=\"40\"/>\n"
+     "  </job>\n"
+     "  <job id='a&amp;b' runtime='3.5'>\n"
+     "    <uses name=\"f1\" link=\"input\"/>\n"
+     "    <uses file=\"f2\" link=\"input\"/>\n"
+     "    <uses file=\"raw\" link=\"input\" size=\"1000\"/>\n"
+     "  </job>\n"
+     "  <dax:job id=\"ID3\"/>\n"
+     "  <child ref=\"a&amp;b\"><parent ref=\"ID1\"/></child>\n"
+     "  <child ref=\"ID3\">\n"
+     "    <parent ref=\"ID1\"/>\n"
+     "    <parent ref=\"a&amp;b\"/>\n"
+     "  </child>\n"
+     "</adag>\n",
+     "ID1->ID3:0 ID1->a&b:14 ID1=2 ID3=0 a&b->ID3:0 a&b=4", nullptr, 10},
+    {"DAX, unterminated element", WorkflowFormat::Dax, "<adag><job id=\"a\"", nullptr, "Unterminated element job", 0},
+    {"DAX, unquoted value", WorkflowFormat::Dax, "<adag><job id=a/></adag>", nullptr, "Expected a quoted value for attribute id", 0},
+    {"DAX, attribute without value", WorkflowFormat::Dax, "<adag><job id/></adag>", nullptr, "Expected '=' after attribute id", 0},
+    {"DAX, negative runtime", WorkflowFormat::Dax, "<adag><job id=\"a\" runtime=\"-3\"/></adag>", nullptr, "Runtime is negative", 0},
+    {"DAX, unknown parent", WorkflowFormat::Dax,
+     "<adag><job id=\"a\"/><child ref=\"a\"><parent ref=\"b\"/></child></adag>", nullptr, "Unknown task: b", 0},
+
+    {"WfCommons", WorkflowFormat::WfCommons,
+     "{\"name\": \"new schema\", \"schemaVersion\": \"1.5\", \"workflow\": {\n"
+     "  \"specification\": {\n"
+     "    \"tasks\": [\n"
+     "      {\"id\": \"t1\", \"name\": \"one\", \"parents\": [], \"outputFiles\": [\"f\"]},\n"
+     "      {\"id\": \"t2\", \"name\": \"two\", \"parents\": [\"one\"], \"inputFiles\": [\"f\", \"g\"], \"extra\": [1, {\"x\": null}]}\n"
+     "    ],\n"
+     "    \"files\": [{\"id\": \"f\", \"sizeInBytes\": 50}, {\"id\": \"g\", \"sizeInBytes\": null}]\n"
+     "  },\n"
+     "  \"execution\": {\"tasks\": [{\"id\": \"t1\", \"runtimeInSeconds\": 2.0}, {\"id\": \"t2\", \"runtimeInSeconds\": null}]}\n"
+     "}}\n",
+     "t1->t2:5 t1=2 t2=0", nullptr, 10},
+    {"WfCommons, old schema", WorkflowFormat::WfCommons,
+     "{\"workflow\": {\"tasks\": [\n"
+     "  {\"name\": \"a\\u00e9\\ud83d\\ude00\\t\\\"\", \"runtime\": \"1.5\",\n"
+     "   \"files\": [{\"link\": \"output\", \"name\": \"f\", \"size\": 20}, {\"link\": \"output\", \"name\": \"g\", \"size\": null}]},\n"
+     "  {\"name\": \"b\\u0041\", \"runtime\": 1e1, \"parents\": [\"a\\u00E9\\uD83D\\uDE00\\t\\\"\"],\n"
+     "   \"files\": [{\"link\": \"input\", \"name\": \"f\", \"size\": 20}, {\"link\": \"input\", \"name\": \"g\", \"size\": 60}]}\n"
+     "]}}\n",
+     "a\xc3\xa9\xf0\x9f\x98\x80\t\"->bA:8 a\xc3\xa9\xf0\x9f\x98\x80\t\"=2 bA=10", nullptr, 10},
+    {"WfCommons, boolean runtime", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"a\", \"runtime\": true}]}", nullptr,
+     "Expected a number, got true", 0},
+    {"WfCommons, object runtime", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"a\", \"runtime\": {}}]}", nullptr,
+     "Expected a number, got '{'", 0},
+    {"WfCommons, missing runtime", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"a\", \"runtime\":", nullptr,
+     "Unexpected end of file", 0},
+    {"WfCommons, short escape", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"\\u12g4\"}]}", nullptr,
+     "Expected 4 hexadecimal digits after \\u", 0},
+    {"WfCommons, unpaired high surrogate", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"\\ud83dx\"}]}", nullptr,
+     "Unpaired high surrogate", 0},
+    {"WfCommons, high surrogate and another escape", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"\\ud83d\\u0041\"}]}",
+     nullptr, "Unpaired high surrogate", 0},
+    {"WfCommons, unpaired low surrogate", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"\\ude00\"}]}", nullptr,
+     "Unpaired low surrogate", 0},
+    {"WfCommons, unterminated string", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"a", nullptr, "Unterminated string", 0},
+    {"WfCommons, missing comma", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"a\" \"runtime\": 1}]}", nullptr,
+     "Expected '}'", 0},
+    {"WfCommons, task without id", WorkflowFormat::WfCommons, "{\"tasks\": [{\"runtime\": 1}]}", nullptr,
+     "Task without id or name", 0},
+    {"WfCommons, not an object", WorkflowFormat::WfCommons, "[]", nullptr, "Expected a JSON object", 0},
+    {"WfCommons, negative runtime", WorkflowFormat::WfCommons, "{\"tasks\": [{\"id\": \"a\", \"runtime\": -1}]}", nullptr,
+     "Runtime is negative", 0},
+};
+
+/**
+ * @param graph The workflow
+ * @return Jobs as "name=time" and communications as "from->to:time", sorted and separated by spaces
+ */
+static std::string describeWorkflow(WorkflowGraph& graph) {
+    const CSRWorkflowGraph& csr = graph.freeze();
+    std::vector<std::string> items;
+    for (JobId job = 0; job < csr.getNumJobs(); job++) {
+        items.emplace_back(std::string(graph.getJobName(job)) + "=" + std::to_string(csr.getExecutionTime(job)));
+        for (const CSREdge& comm: csr.getOutEdges(job)) {
+            items.emplace_back(std::string(graph.getJobName(job)) + "->" + graph.getJobName(comm.job) + ":" +
+                               std::to_string(comm.commTime));
+        }
+    }
+    std::sort(items.begin(), items.end());
+    std::string description;
+    for (const std::string& item: items) {
+        description += (description.empty() ? "" : " ") + item;
+    }
+    return description;
+}
+
+int main() {
+    char directory[] = "/tmp/formats_test.XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        std::fprintf(stderr, "cannot create a temporary directory\n");
+        return EXIT_FAILURE;
+    }
+    std::string path = std::string(directory) + "/workflow";
+
+    int numCases = 0, numFailures = 0;
+    for (const FormatCase& formatCase: CASES) {
+        {
+            std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+            out << formatCase.content;
+        }
+        WorkflowGraph graph;
+        WorkflowReadOptions options;
+        options.bandwidth = formatCase.bandwidth;
+        std::string description, error;
+        try {
+            readWorkflow(path, formatCase.format, graph, options);
+            description = describeWorkflow(graph);
+        } catch (const std::runtime_error& e) {
+            error = e.what();
+        }
+
+        numCases++;
+        if (formatCase.error == nullptr && (!error.empty() || description != formatCase.expected)) {
+            std::fprintf(stderr, "%s: read \"%s\"%s%s, expected \"%s\"\n", formatCase.name, description.c_str(),
+                         error.empty() ? "" : " with error ", error.c_str(), formatCase.expected);
+            numFailures++;
+        } else if (formatCase.error != nullptr && error.find(formatCase.error) == std::string::npos) {
+            std::fprintf(stderr, "%s: error \"%s\", expected \"%s\"\n", formatCase.name, error.c_str(), formatCase.error);
+            numFailures++;
+        }
+    }
+
+    std::remove(path.c_str());
+    rmdir(directory);
+    std::printf("formats_test: %d files, %d failures\n", numCases, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
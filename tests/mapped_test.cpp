@@ -0,0 +1,212 @@
+/*
+Checks the binary workflow format. Writing a workflow and mapping it back must
+give the same CSR form, array by array, the same job names and the same
+schedule. Files that are truncated, that aren't workflow files, or whose
+offsets, edges, times or names are out of range or inconsistent must be
+rejected when mapped, before anything reads out of bounds.
+
+Usage: mapped_test [number of workflows]   (default: 300)
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "reference.h"
+
+/**
+ * Compares a workflow with the one mapped from its file, reporting the first difference on the standard error.
+ * @param context Description of the case, printed with a difference
+ * @param graph The workflow written
+ * @param mapped The workflow mapped
+ * @return True if they are identical, false otherwise
+ */
+static bool checkSameWorkflow(const std::string& context, WorkflowGraph& graph, const MappedWorkflow& mapped) {
+    const CSRWorkflowGraph& expected = graph.freeze();
+    const CSRWorkflowGraph& actual = mapped.getGraph();
+    auto isSame = [](Span<CSREdge> a, Span<CSREdge> b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].job != b[i].job || a[i].commTime != b[i].commTime) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (expected.getNumJobs() != actual.getNumJobs() || expected.getNumCommunications() != actual.getNumCommunications()) {
+        std::fprintf(stderr, "%s: mapped %zu jobs and %zu communications, expected %zu and %zu\n", context.c_str(),
+                     actual.getNumJobs(), actual.getNumCommunications(), expected.getNumJobs(),
+                     expected.getNumCommunications());
+        return false;
+    }
+    for (JobId job = 0; job < expected.getNumJobs(); job++) {
+        if (expected.getExecutionTime(job) != actual.getExecutionTime(job) ||
+            !isSame(expected.getOutEdges(job), actual.getOutEdges(job)) ||
+            !isSame(expected.getInEdges(job), actual.getInEdges(job)) ||
+            std::strcmp(graph.getJobName(job), mapped.getJobName(job)) != 0) {
+            std::fprintf(stderr, "%s: job %u differs once mapped\n", context.c_str(), job);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @param path Path of the file
+ * @return Content of the file
+ */
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @param path Path of the file
+ * @param bytes Content of the file
+ */
+static void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+}
+
+/**
+ * Overwrites a value in the bytes of a file.
+ * @param bytes Content of the file
+ * @param offset Position of the value
+ * @param value New value
+ * @return Content of the file with the value overwritten
+ */
+template <class T>
+static std::string patch(std::string bytes, uint64_t offset, T value) {
+    std::memcpy(&bytes[offset], &value, sizeof(value));
+    return bytes;
+}
+
+/**
+ * Checks that mapping a file is rejected.
+ * @param context Description of the case, printed if the file is accepted
+ * @param path Path of the file
+ * @param bytes Content of the file
+ * @return 0 if the file was rejected, 1 otherwise
+ */
+static int checkRejected(const std::string& context, const std::string& path, const std::string& bytes) {
+    writeFile(path, bytes);
+    try {
+        MappedWorkflow mapped(path);
+        std::fprintf(stderr, "%s: file accepted\n", context.c_str());
+        return 1;
+    } catch (const std::runtime_error&) {
+        return 0;
+    }
+}
+
+/**
+ * Checks that corrupt variants of the file of a workflow with at least two jobs and a communication are rejected.
+ * @param path Path of the file
+ * @param bytes Content of the valid file
+ * @return Number of corrupt files accepted
+ */
+static int checkCorruptFiles(const std::string& path, const std::string& bytes) {
+    WorkflowFileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    uint64_t numJobs = header.numJobs, numEdges = header.numEdges;
+    CSREdge edge;
+    std::memcpy(&edge, &bytes[header.inEdges], sizeof(edge));
+
+    int numFailures = 0;
+    for (size_t length = 0; length < bytes.size(); length += 1 + length / 4) {
+        numFailures += checkRejected("truncated to " + std::to_string(length) + " bytes", path, bytes.substr(0, length));
+    }
+    numFailures += checkRejected("trailing bytes", path, bytes + std::string(8, '\0'));
+    numFailures += checkRejected("bad magic", path, patch<uint32_t>(bytes, 0, 0x31474658u));
+    numFailures += checkRejected("bad version", path, patch<uint32_t>(bytes, 4, 2));
+    numFailures += checkRejected("misaligned section", path,
+                                 patch<uint64_t>(bytes, offsetof(WorkflowFileHeader, outEdges), header.outEdges + 4));
+    numFailures += checkRejected("section past the end", path,
+                                 patch<uint64_t>(bytes, offsetof(WorkflowFileHeader, inEdges), header.fileSize));
+    numFailures += checkRejected("huge number of jobs", path,
+                                 patch<uint64_t>(bytes, offsetof(WorkflowFileHeader, numJobs), UINT64_MAX / 2));
+    numFailures += checkRejected("first offset not zero", path, patch<uint32_t>(bytes, header.outOffsets, 1));
+    numFailures += checkRejected("last offset past the edges", path,
+                                 patch<uint32_t>(bytes, header.inOffsets + numJobs * 4, numEdges + 1));
+    numFailures += checkRejected("offset out of range", path, patch<uint32_t>(bytes, header.outOffsets + 4, UINT32_MAX));
+    numFailures += checkRejected("decreasing offsets", path,
+                                 patch<uint32_t>(patch<uint32_t>(bytes, header.outOffsets + 4, numEdges),
+                                                 header.outOffsets + 8, 0));
+    numFailures += checkRejected("edge to a missing job", path, patch<uint32_t>(bytes, header.outEdges, numJobs));
+    numFailures += checkRejected("negative communication time", path, patch<int32_t>(bytes, header.inEdges + 4, -1));
+    numFailures += checkRejected("negative execution time", path, patch<int32_t>(bytes, header.executionTimes, -1));
+    numFailures += checkRejected("incoming edge from another job", path,
+                                 patch<uint32_t>(bytes, header.inEdges, (edge.job + 1) % numJobs));
+    numFailures += checkRejected("name past the names", path,
+                                 patch<uint32_t>(bytes, header.nameOffsets, header.numNameChars));
+    numFailures += checkRejected("names without terminator", path,
+                                 patch<char>(bytes, header.names + header.numNameChars - 1, 'x'));
+    return numFailures;
+}
+
+int main(int argc, char** argv) {
+    int numWorkflows = argc > 1 ? std::atoi(argv[1]) : 300;
+    char directory[] = "/tmp/mapped_test.XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        std::fprintf(stderr, "cannot create a temporary directory\n");
+        return EXIT_FAILURE;
+    }
+    std::string path = std::string(directory) + "/workflow.wfg";
+
+    std::mt19937 rng(19);
+    int numFailures = 0;
+    for (int seed = 0; seed <= numWorkflows; seed++) {
+        // the first workflow is empty
+        RandomWorkflow workflow;
+        if (seed > 0) {
+            workflow = generateRandomWorkflow(rng);
+        }
+        WorkflowGraph graph;
+        for (size_t job = 0; job < workflow.executionTimes.size(); job++) {
+            // names of every length, including empty ones and bytes outside ASCII
+            graph.addJob(job == 0 ? "" : std::string(rng() % 12, static_cast<char>('a' + job % 26)) + "\xc3\xa9" +
+                                         std::to_string(job), workflow.executionTimes[job]);
+        }
+        graph.addCommunications(workflow.commTimes.size(), workflow.fromJobs.data(), workflow.toJobs.data(),
+                                workflow.commTimes.data());
+        std::string context = "workflow " + std::to_string(seed);
+        try {
+            writeWorkflowFile(path, graph);
+            MappedWorkflow mapped(path);
+            if (!checkSameWorkflow(context, graph, mapped)) {
+                numFailures++;
+                continue;
+            }
+            int numMachines = 1 + rng() % 4;
+            WorkflowSchedule expected(&graph, numMachines), actual(&mapped.getGraph(), numMachines);
+            numFailures += !checkSameSchedule(context, expected.schedule(), actual.schedule());
+        } catch (const std::runtime_error& e) {
+            std::fprintf(stderr, "%s: %s\n", context.c_str(), e.what());
+            numFailures++;
+            continue;
+        }
+        if (seed % 10 == 0 && graph.getNumJobs() >= 2 && graph.getNumCommunications() > 0) {
+            numFailures += checkCorruptFiles(path, readFile(path));
+        }
+    }
+    numFailures += checkRejected("empty file", path, "");
+    try {
+        MappedWorkflow mapped(std::string(directory) + "/missing.wfg");
+        std::fprintf(stderr, "missing file mapped\n");
+        numFailures++;
+    } catch (const std::runtime_error&) {
+    }
+
+    std::remove(path.c_str());
+    rmdir(directory);
+    std::printf("mapped_test: %d workflows, %d failures\n", numWorkflows, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,98 @@
+/*
+Checks OnlineScheduler on random DAGs. Submitting the jobs in the order
+schedule() placed them must give the same placements as schedule(), and one
+more job, submitted either to that streamed scheduler or to one continuing
+after the schedule, must be placed as ReferencePlacer places it. A dependency
+on a job not submitted yet must be rejected.
+
+Usage: online_test [number of workflows]   (default: 500)
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "reference.h"
+
+int main(int argc, char** argv) {
+    int numWorkflows = argc > 1 ? std::atoi(argv[1]) : 500;
+    const PlacementPolicy policies[] = {PlacementPolicy::Append, PlacementPolicy::Insertion};
+    const char* policyNames[] = {"append", "insertion"};
+
+    std::mt19937 rng(17);
+    int numFailures = 0;
+    for (int seed = 0; seed < numWorkflows; seed++) {
+        RandomWorkflow workflow = generateRandomWorkflow(rng);
+        CSRWorkflowGraph graph = workflow.freeze();
+        JobId numJobs = graph.getNumJobs();
+        int numMachines = 1 + rng() % 6;
+
+        // one more job depending on random jobs of the workflow
+        RandomWorkflow extended = workflow;
+        extended.executionTimes.emplace_back(rng() % 7);
+        for (int i = rng() % 4; i > 0; i--) {
+            extended.fromJobs.emplace_back(rng() % numJobs);
+            extended.toJobs.emplace_back(numJobs);
+            extended.commTimes.emplace_back(rng() % 9);
+        }
+        CSRWorkflowGraph extendedGraph = extended.freeze();
+
+        for (int p = 0; p < 2; p++) {
+            std::string context = "workflow " + std::to_string(seed) + ", " + std::to_string(numMachines) + " machines, " + policyNames[p];
+            WorkflowSchedule schedule(&graph, numMachines);
+            schedule.setPlacementPolicy(policies[p]);
+            std::pair<int, ScheduleOrder> expected = schedule.schedule();
+
+            // stream the jobs in schedule order, where they get the id of their position
+            OnlineScheduler streamed(numMachines, policies[p]);
+            std::vector<JobId> submittedIds(numJobs + 1);
+            std::pair<int, ScheduleOrder> actual;
+            for (ScheduledJob& scheduledJob: expected.second) {
+                auto inEdges = graph.getInEdges(scheduledJob.jobId);
+                std::vector<CSREdge> dependencies(inEdges.begin(), inEdges.end());
+                for (CSREdge& dependency: dependencies) {
+                    dependency.job = submittedIds[dependency.job];
+                }
+                actual.second.emplace_back(streamed.submit(graph.getExecutionTime(scheduledJob.jobId), dependencies));
+                submittedIds[scheduledJob.jobId] = actual.second.back().jobId;
+                scheduledJob.jobId = actual.second.back().jobId;
+            }
+            actual.first = streamed.getMakespan();
+            numFailures += !checkSameSchedule(context + ", streamed", expected, actual);
+
+            // place the extra job after the schedule, from the streamed scheduler and from one seeded with the schedule
+            ReferencePlacer reference(extendedGraph, numMachines, policies[p]);
+            for (JobId job: schedule.topologicalSort()) {
+                reference.place(job);
+            }
+            ScheduledJob extraJob = reference.place(numJobs);
+            int executionTime = extendedGraph.getExecutionTime(numJobs);
+            auto inEdges = extendedGraph.getInEdges(numJobs);
+            std::vector<CSREdge> dependencies(inEdges.begin(), inEdges.end());
+            OnlineScheduler seeded(schedule.schedule().second, numMachines, policies[p]);
+            ScheduledJob seededJob = seeded.submit(executionTime, dependencies);
+            std::pair<int, ScheduleOrder> seededResult(seeded.getMakespan(), ScheduleOrder(1, seededJob));
+            for (CSREdge& dependency: dependencies) {
+                dependency.job = submittedIds[dependency.job];
+            }
+            ScheduledJob streamedJob = streamed.submit(executionTime, dependencies);
+            std::pair<int, ScheduleOrder> streamedResult(streamed.getMakespan(), ScheduleOrder(1, streamedJob));
+            std::pair<int, ScheduleOrder> referenceResult(reference.getMakespan(), ScheduleOrder(1, extraJob));
+            numFailures += !checkSameSchedule(context + ", seeded extra job", referenceResult, seededResult);
+            numFailures += !checkSameSchedule(context + ", streamed extra job", referenceResult, streamedResult);
+
+            try {
+                std::vector<CSREdge> ahead(1, CSREdge{static_cast<JobId>(seeded.getNumJobs()), 0});
+                seeded.submit(1, ahead);
+                std::fprintf(stderr, "%s: dependency on a job not submitted yet accepted\n", context.c_str());
+                numFailures++;
+            } catch (const std::out_of_range&) {
+            }
+        }
+    }
+
+    std::printf("online_test: %d workflows, %d failures\n", numWorkflows, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,243 @@
+/*
+Checks the exact output of the schedule writers: the text, CSV, JSON and Chrome
+trace formats with jobs written by name or by id, names that need quoting or
+JSON escapes, extreme times and empty schedules, and the records of the binary
+format. The buffered output must write integers exactly, keep what it writes
+until its buffer is full, it is flushed or it is destroyed, and write it all
+whatever the size of its buffer. Random workflows are also scheduled straight
+into the binary writer, which must give the same schedule as computing it.
+
+Usage: output_test [number of workflows]   (default: 300)
+*/
+
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "reference.h"
+
+/**
+ * @param path Path of the file
+ * @return Content of the file
+ */
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Compares an output with the expected one, reporting the first difference on the standard error.
+ * @param context Description of the case, printed with a difference
+ * @param expected Expected output
+ * @param actual Output written
+ * @return 0 if the outputs are identical, 1 otherwise
+ */
+static int checkSameOutput(const std::string& context, const std::string& expected, const std::string& actual) {
+    if (expected == actual) {
+        return 0;
+    }
+    size_t at = 0;
+    while (at < expected.size() && at < actual.size() && expected[at] == actual[at]) {
+        at++;
+    }
+    std::fprintf(stderr, "%s: output differs at byte %zu\nexpected: %s\nactual:   %s\n", context.c_str(), at,
+                 expected.substr(at, 60).c_str(), actual.substr(at, 60).c_str());
+    return 1;
+}
+
+/**
+ * Writes a schedule in a format into a file.
+ * @param path Path of the file
+ * @param format Format of the schedule
+ * @param jobNames Name of every job, or empty to write ids
+ * @param order Jobs of the schedule
+ * @param makespan Makespan of the schedule
+ * @return Content of the file
+ */
+static std::string writeSchedule(const std::string& path, ScheduleFormat format, JobNameFunction jobNames,
+                                 const ScheduleOrder& order, int makespan) {
+    {
+        BufferedOutput out(path);
+        std::unique_ptr<ScheduleWriter> writer = makeScheduleWriter(format, out, jobNames);
+        for (const ScheduledJob& scheduledJob: order) {
+            writer->write(scheduledJob);
+        }
+        writer->finish(makespan);
+    }
+    return readFile(path);
+}
+
+/**
+ * Checks the output of every format on a schedule whose job names need quoting and escaping, and on an empty one.
+ * @param path Path of a temporary file
+ * @return Number of outputs that differ from the expected ones
+ */
+static int checkFormats(const std::string& path) {
+    static const char* const names[] = {"plain", "say \"hi\" \\o/", "tab\tline\nbell\x07", "a,b", "\xc3\xa9t\xc3\xa9"};
+    JobNameFunction jobNames = [](JobId job) { return names[job]; };
+    ScheduleOrder order = {ScheduledJob(0, 0, 0, 0, 3), ScheduledJob(1, 1, 0, 2, 2), ScheduledJob(2, 0, 3, 3, INT_MAX),
+                           ScheduledJob(3, 2, -1, -5, 0), ScheduledJob(4, 1, 2, 2, 7)};
+    int makespan = INT_MAX;
+
+    int numFailures = checkSameOutput("text", "Scheduled Order:\n"
+        " Schedule Job \"plain\" at machine 0 at time 0 where execution starts at 0 and finishes at 3\n"
+        " Schedule Job \"say \"hi\" \\o/\" at machine 1 at time 0 where execution starts at 2 and finishes at 2\n"
+        " Schedule Job \"tab\tline\nbell\x07\" at machine 0 at time 3 where execution starts at 3 and finishes at 2147483647\n"
+        " Schedule Job \"a,b\" at machine 2 at time -1 where execution starts at -5 and finishes at 0\n"
+        " Schedule Job \"\xc3\xa9t\xc3\xa9\" at machine 1 at time 2 where execution starts at 2 and finishes at 7\n"
+        "\nMinimum time to complete workflow: 2147483647\n",
+        writeSchedule(path, ScheduleFormat::Text, jobNames, order, makespan));
+    numFailures += checkSameOutput("CSV", "job,machine,schedule_time,start_time,finish_time\n"
+        "plain,0,0,0,3\n"
+        "\"say \"\"hi\"\" \\o/\",1,0,2,2\n"
+        "\"tab\tline\nbell\x07\",0,3,3,2147483647\n"
+        "\"a,b\",2,-1,-5,0\n"
+        "\xc3\xa9t\xc3\xa9,1,2,2,7\n",
+        writeSchedule(path, ScheduleFormat::Csv, jobNames, order, makespan));
+    numFailures += checkSameOutput("JSON", "{\"jobs\":[\n"
+        "{\"job\":\"plain\",\"machine\":0,\"scheduleTime\":0,\"startTime\":0,\"finishTime\":3},\n"
+        "{\"job\":\"say \\\"hi\\\" \\\\o/\",\"machine\":1,\"scheduleTime\":0,\"startTime\":2,\"finishTime\":2},\n"
+        "{\"job\":\"tab\\u0009line\\u000abell\\u0007\",\"machine\":0,\"scheduleTime\":3,\"startTime\":3,\"finishTime\":2147483647},\n"
+        "{\"job\":\"a,b\",\"machine\":2,\"scheduleTime\":-1,\"startTime\":-5,\"finishTime\":0},\n"
+        "{\"job\":\"\xc3\xa9t\xc3\xa9\",\"machine\":1,\"scheduleTime\":2,\"startTime\":2,\"finishTime\":7}\n"
+        "],\"makespan\":2147483647}\n",
+        writeSchedule(path, ScheduleFormat::Json, jobNames, order, makespan));
+    numFailures += checkSameOutput("JSON by id", "{\"jobs\":[\n"
+        "{\"job\":0,\"machine\":0,\"scheduleTime\":0,\"startTime\":0,\"finishTime\":3},\n"
+        "{\"job\":4,\"machine\":1,\"scheduleTime\":2,\"startTime\":2,\"finishTime\":7}\n"
+        "],\"makespan\":7}\n",
+        writeSchedule(path, ScheduleFormat::Json, JobNameFunction(), {order[0], order[4]}, 7));
+    numFailures += checkSameOutput("Chrome trace", "{\"traceEvents\":[\n"
+        "{\"name\":\"say \\\"hi\\\" \\\\o/\",\"ph\":\"X\",\"pid\":0,\"tid\":1,\"ts\":2,\"dur\":0,\"args\":{\"scheduleTime\":0}},\n"
+        "{\"name\":\"3\",\"ph\":\"X\",\"pid\":0,\"tid\":2,\"ts\":-5,\"dur\":5,\"args\":{\"scheduleTime\":-1}},\n"
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"Workflow\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Machine 0\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"Machine 1\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":2,\"args\":{\"name\":\"Machine 2\"}}\n"
+        "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"makespan\":0}}\n",
+        writeSchedule(path, ScheduleFormat::ChromeTrace, [](JobId job) { return job == 3 ? nullptr : names[job]; },
+                      {order[1], order[3]}, 0));
+
+    int32_t records[] = {BinaryScheduleWriter::MAGIC, 1, 1, 0, 2, 2, 3, 2, -1, -5, 0,
+                         static_cast<int32_t>(BinaryScheduleWriter::END_MAGIC), 2, 9};
+    numFailures += checkSameOutput("binary", std::string(reinterpret_cast<const char*>(records), sizeof(records)),
+                                   writeSchedule(path, ScheduleFormat::Binary, jobNames, {order[1], order[3]}, 9));
+
+    numFailures += checkSameOutput("empty text", "Scheduled Order:\n\nMinimum time to complete workflow: 0\n",
+                                   writeSchedule(path, ScheduleFormat::Text, jobNames, {}, 0));
+    numFailures += checkSameOutput("empty CSV", "job,machine,schedule_time,start_time,finish_time\n",
+                                   writeSchedule(path, ScheduleFormat::Csv, jobNames, {}, 0));
+    numFailures += checkSameOutput("empty JSON", "{\"jobs\":[],\"makespan\":0}\n",
+                                   writeSchedule(path, ScheduleFormat::Json, jobNames, {}, 0));
+    numFailures += checkSameOutput("empty Chrome trace", "{\"traceEvents\":[\n"
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"Workflow\"}}\n"
+        "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"makespan\":0}}\n",
+        writeSchedule(path, ScheduleFormat::ChromeTrace, jobNames, {}, 0));
+    return numFailures;
+}
+
+/**
+ * Checks the integers and strings of the buffered output, that it holds what it writes until it is flushed or
+ * destroyed, and that small buffers and writes larger than the buffer give the same output.
+ * @param path Path of a temporary file
+ * @return Number of outputs that differ from the expected ones
+ */
+static int checkBufferedOutput(const std::string& path) {
+    std::string expected = "-9223372036854775808 9223372036854775807 -1 0 42 " + std::string(100, 'x') + ",\"\\\"\",,";
+    int numFailures = 0;
+    for (size_t bufferSize: {1, 2, 7, 64, 1 << 20}) {
+        std::string context = "buffer of " + std::to_string(bufferSize) + " bytes";
+        {
+            BufferedOutput out(path, bufferSize);
+            for (int64_t value: {INT64_MIN, INT64_MAX, int64_t(-1), int64_t(0), int64_t(42)}) {
+                out.writeInt(value);
+                out.put(' ');
+            }
+            out.writeString(std::string(100, 'x').c_str());
+            out.put(',');
+            out.writeJsonString("\"");
+            out.put(',');
+            out.writeCsvField("");
+            out.put(',');
+            if (bufferSize > expected.size()) {
+                numFailures += checkSameOutput(context + ", before the flush", "", readFile(path));
+            }
+        }
+        numFailures += checkSameOutput(context + ", after destruction", expected, readFile(path));
+    }
+
+    // an explicit flush writes everything, and the output can be written again afterwards
+    {
+        BufferedOutput out(path);
+        out.writeString("flushed");
+        out.flush();
+        numFailures += checkSameOutput("flush", "flushed", readFile(path));
+        out.writeString(" and destroyed");
+    }
+    numFailures += checkSameOutput("flush, after destruction", "flushed and destroyed", readFile(path));
+
+    try {
+        BufferedOutput out(path + ".missing/schedule.txt");
+        std::fprintf(stderr, "output opened in a missing directory\n");
+        numFailures++;
+    } catch (const std::runtime_error&) {
+    }
+    return numFailures;
+}
+
+int main(int argc, char** argv) {
+    int numWorkflows = argc > 1 ? std::atoi(argv[1]) : 300;
+    char directory[] = "/tmp/output_test.XXXXXX";
+    if (mkdtemp(directory) == nullptr) {
+        std::fprintf(stderr, "cannot create a temporary directory\n");
+        return EXIT_FAILURE;
+    }
+    std::string path = std::string(directory) + "/schedule";
+
+    int numFailures = checkFormats(path);
+    numFailures += checkBufferedOutput(path);
+
+    std::mt19937 rng(21);
+    for (int seed = 0; seed < numWorkflows; seed++) {
+        CSRWorkflowGraph graph = generateRandomWorkflow(rng).freeze();
+        int numMachines = 1 + rng() % 4;
+        WorkflowSchedule schedule(&graph, numMachines);
+        std::pair<int, ScheduleOrder> expected = schedule.computeSchedule(), actual;
+        {
+            BufferedOutput out(path, 1 + rng() % 64);
+            BinaryScheduleWriter writer(out);
+            schedule.schedule(writer);
+        }
+
+        // reads the records back between the magic word and the footer
+        std::string bytes = readFile(path);
+        std::vector<int32_t> words(bytes.size() / sizeof(int32_t));
+        std::memcpy(words.data(), bytes.data(), words.size() * sizeof(int32_t));
+        size_t numJobs = words.size() >= 4 ? (words.size() - 4) / 5 : 0;
+        if (bytes.size() != (4 + 5 * numJobs) * sizeof(int32_t) || words[0] != static_cast<int32_t>(BinaryScheduleWriter::MAGIC) ||
+            words[1 + 5 * numJobs] != static_cast<int32_t>(BinaryScheduleWriter::END_MAGIC) ||
+            words[2 + 5 * numJobs] != static_cast<int32_t>(numJobs)) {
+            std::fprintf(stderr, "workflow %d: malformed binary schedule of %zu bytes\n", seed, bytes.size());
+            numFailures++;
+            continue;
+        }
+        actual.first = words[3 + 5 * numJobs];
+        for (size_t job = 0; job < numJobs; job++) {
+            const int32_t* record = &words[1 + 5 * job];
+            actual.second.emplace_back(record[0], record[1], record[2], record[3], record[4]);
+        }
+        numFailures += !checkSameSchedule("workflow " + std::to_string(seed), expected, actual);
+    }
+
+    std::remove(path.c_str());
+    rmdir(directory);
+    std::printf("output_test: %d workflows, %d failures\n", numWorkflows, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
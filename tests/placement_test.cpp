@@ -0,0 +1,56 @@
+/*
+Checks the placement of WorkflowSchedule, appending and inserting into idle gaps,
+against ReferencePlacer on random DAGs. Jobs are placed in the static
+critical-path order in both, so any difference comes from the placement: the
+search of the tournament tree and of the gap treaps must find the same machine
+and start time as trying every machine and every gap.
+
+Usage: placement_test [number of workflows]   (default: 2000)
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include "reference.h"
+
+/**
+ * Schedules a workflow in a given order with ReferencePlacer.
+ * @param graph The workflow
+ * @param topOrder Order in which jobs are placed
+ * @param numMachines Number of machines
+ * @param policy Placement policy
+ * @return Makespan and scheduled jobs
+ */
+static std::pair<int, ScheduleOrder> referenceSchedule(const CSRWorkflowGraph& graph, const std::vector<JobId>& topOrder,
+                                                       int numMachines, PlacementPolicy policy) {
+    ReferencePlacer placer(graph, numMachines, policy);
+    ScheduleOrder scheduleOrder;
+    for (JobId job: topOrder) {
+        scheduleOrder.emplace_back(placer.place(job));
+    }
+    return {placer.getMakespan(), scheduleOrder};
+}
+
+int main(int argc, char** argv) {
+    int numWorkflows = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const PlacementPolicy policies[] = {PlacementPolicy::Append, PlacementPolicy::Insertion};
+    const char* policyNames[] = {"append", "insertion"};
+
+    std::mt19937 rng(14);
+    int numFailures = 0;
+    for (int seed = 0; seed < numWorkflows; seed++) {
+        CSRWorkflowGraph graph = generateRandomWorkflow(rng).freeze();
+        int numMachines = 1 + rng() % 6;
+        for (int p = 0; p < 2; p++) {
+            WorkflowSchedule schedule(&graph, numMachines);
+            schedule.setPlacementPolicy(policies[p]);
+            std::pair<int, ScheduleOrder> expected = referenceSchedule(graph, schedule.topologicalSort(), numMachines, policies[p]);
+            std::string context = "workflow " + std::to_string(seed) + ", " + std::to_string(numMachines) + " machines, " + policyNames[p];
+            numFailures += !checkSameSchedule(context, expected, schedule.schedule());
+        }
+    }
+
+    std::printf("placement_test: %d workflows, %d failures\n", numWorkflows, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
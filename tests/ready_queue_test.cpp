@@ -0,0 +1,118 @@
+/*
+Checks that the binary heap, 4-ary heap and radix heap ready queues pop jobs in
+the same order as a brute-force queue taking the most critical pending job:
+highest priority first, smaller id first among equal priorities. Pushes and
+pops are interleaved like in the topological sort, with priorities never above
+the last popped one, drawn among few values so that ties are frequent and
+including INT_MIN, negative values and INT_MAX. Built with
+-fsanitize=undefined, it also catches overflow in the keys of the radix heap.
+
+Usage: ready_queue_test [number of sequences]   (default: 2000)
+*/
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "reference.h"
+
+/**
+ * Draws a priority not above a bound, often one of the extreme values or the bound itself.
+ * @param rng Random generator
+ * @param maxPriority Highest priority allowed
+ * @return The priority
+ */
+static int drawPriority(std::mt19937& rng, int maxPriority) {
+    const int special[] = {INT_MIN, INT_MIN + 1, -2, -1, 0, 1, INT_MAX - 1, INT_MAX};
+    int priority;
+    switch (rng() % 4) {
+    case 0:
+        priority = special[rng() % 8];
+        break;
+    case 1:
+        priority = maxPriority;
+        break;
+    case 2:
+        priority = static_cast<int>(rng() % 7) - 3;
+        break;
+    default:
+        priority = std::uniform_int_distribution<int>(INT_MIN, maxPriority)(rng);
+    }
+    return std::min(priority, maxPriority);
+}
+
+/**
+ * Compares a popped job with the expected one, reporting a difference on the standard error.
+ * @param context Description of the case, printed with a difference
+ * @param name Name of the queue
+ * @param expected Job the brute-force queue popped
+ * @param actual Job the queue popped
+ * @return True if the jobs are identical, false otherwise
+ */
+static bool checkSameJob(const std::string& context, const char* name, const ReadyJob& expected, const ReadyJob& actual) {
+    if (expected.job != actual.job || expected.priority != actual.priority) {
+        std::fprintf(stderr, "%s: %s popped (%d, %u), expected (%d, %u)\n", context.c_str(), name, actual.priority,
+                     actual.job, expected.priority, expected.job);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int numSequences = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    std::mt19937 rng(9);
+    int numFailures = 0;
+    for (int seed = 0; seed < numSequences; seed++) {
+        BinaryHeapReadyQueue binaryHeap;
+        DaryHeapReadyQueue<4> daryHeap;
+        RadixHeapReadyQueue radixHeap;
+        std::vector<ReadyJob> pending;
+        JobId numJobs = 0;
+        int lastPriority = INT_MAX;
+        bool isSame = true;
+        for (int round = 0; isSame && round < 50; round++) {
+            for (int i = rng() % 8; i > 0; i--) {
+                // ids are pushed out of order, so that ties are not broken by insertion order
+                ReadyJob job(drawPriority(rng, lastPriority), numJobs++ * 7919 % 100003);
+                pending.emplace_back(job);
+                binaryHeap.push(job);
+                daryHeap.push(job);
+                radixHeap.push(job);
+            }
+            for (int i = 1 + rng() % 8; isSame && i > 0 && !pending.empty(); i--) {
+                auto top = std::max_element(pending.begin(), pending.end(), JobCriticalityCompare());
+                ReadyJob expected = *top;
+                pending.erase(top);
+                lastPriority = expected.priority;
+                std::string context = "sequence " + std::to_string(seed) + ", round " + std::to_string(round);
+                isSame = checkSameJob(context, "binary heap", expected, binaryHeap.pop()) &&
+                         checkSameJob(context, "4-ary heap", expected, daryHeap.pop()) &&
+                         checkSameJob(context, "radix heap", expected, radixHeap.pop());
+            }
+            if (isSame && (binaryHeap.empty() != pending.empty() || daryHeap.empty() != pending.empty() ||
+                           radixHeap.empty() != pending.empty())) {
+                std::fprintf(stderr, "sequence %d, round %d: queues disagree on being empty\n", seed, round);
+                isSame = false;
+            }
+        }
+
+        // the radix heap must refuse a priority above the last popped one
+        if (isSame && lastPriority < INT_MAX) {
+            try {
+                radixHeap.push(ReadyJob(lastPriority + 1, numJobs));
+                std::fprintf(stderr, "sequence %d: radix heap accepted an increasing priority\n", seed);
+                isSame = false;
+            } catch (const std::invalid_argument&) {
+            }
+        }
+        numFailures += !isSame;
+    }
+
+    std::printf("ready_queue_test: %d sequences, %d failures\n", numSequences, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+/*
+Brute-force reference schedulers and small random workflows shared by the tests.
+The references evaluate every machine for every job, and every idle gap of a
+machine from scratch, so they are slow but obviously right, and the fast
+schedulers of the library must give exactly the same schedules, ties included.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "all.h"
+
+// Jobs and communications of a random workflow, as the parallel arrays the CSR form is built from.
+struct RandomWorkflow {
+    std::vector<int> executionTimes;    ///< Execution time of every job
+    std::vector<JobId> fromJobs;        ///< Source job of every communication
+    std::vector<JobId> toJobs;          ///< Destination job of every communication
+    std::vector<int> commTimes;         ///< Communication time of every communication
+
+    /**
+     * @return Frozen graph of the workflow
+     */
+    CSRWorkflowGraph freeze() const {
+        return CSRWorkflowGraph(executionTimes.size(), executionTimes.data(), commTimes.size(), fromJobs.data(),
+                                toJobs.data(), commTimes.data());
+    }
+};
+
+/**
+ * Draws a random DAG of up to maxJobs jobs, where every job depends on every earlier job with a random density.
+ * Times are small, with some of zero, so that ties in priorities and start times are frequent.
+ * @param rng Random generator
+ * @param maxJobs Largest number of jobs
+ * @return The workflow
+ */
+inline RandomWorkflow generateRandomWorkflow(std::mt19937& rng, size_t maxJobs = 30) {
+    RandomWorkflow workflow;
+    size_t numJobs = 1 + rng() % maxJobs;
+    std::bernoulli_distribution hasEdge(0.05 + 0.05 * (rng() % 8));
+    for (JobId job = 0; job < numJobs; job++) {
+        workflow.executionTimes.emplace_back(rng() % 8 == 0 ? 0 : 1 + rng() % 6);
+        for (JobId predecessor = 0; predecessor < job; predecessor++) {
+            if (hasEdge(rng)) {
+                workflow.fromJobs.emplace_back(predecessor);
+                workflow.toJobs.emplace_back(job);
+                workflow.commTimes.emplace_back(rng() % 9);
+            }
+        }
+    }
+    return workflow;
+}
+
+/**
+ * Places jobs one at a time like JobPlacer, but by trying every machine and scanning the jobs of every machine for
+ * the earliest idle gap. A job goes to the machine where it starts earliest, the one with the smallest ID on ties.
+ * With insertion, a job runs in the earliest idle gap fitting it or after the last job of the machine, and a job of
+ * zero length needs an idle instant, the ends of a gap included, without occupying the machine.
+ */
+class ReferencePlacer {
+private:
+    const CSRWorkflowGraph& graph;      ///< Workflow whose jobs are placed
+    PlacementPolicy policy;             ///< How the start time on a machine is chosen
+    std::vector<std::vector<std::pair<int, int>>> busyTimes;  ///< Sorted start and finish times of the jobs of every machine
+    std::vector<int> machineFinishTimes;  ///< Finish time of the last job of every machine, given as schedule time
+    std::vector<int> jobMachines;       ///< Machine of every placed job
+    std::vector<int> jobFinishTimes;    ///< Finish time of every placed job
+    int makespan = 0;                   ///< Latest finish time of the placed jobs
+
+    /**
+     * @param machine ID of the machine
+     * @param job Id of the job, whose predecessors are placed
+     * @return Earliest start time of the job on the machine
+     */
+    int findStart(int machine, JobId job) const {
+        int readyTime = 0;
+        for (const CSREdge& comm: graph.getInEdges(job)) {
+            readyTime = std::max(readyTime, jobFinishTimes[comm.job] + (jobMachines[comm.job] == machine ? 0 : comm.commTime));
+        }
+        int executionTime = graph.getExecutionTime(job);
+        if (policy == PlacementPolicy::Append) {
+            return std::max(readyTime, machineFinishTimes[machine]);
+        }
+
+        int idleFrom = 0, start = -1;
+        for (const auto& busy: busyTimes[machine]) {
+            int gapStart = std::max(idleFrom, readyTime);
+            if (idleFrom < busy.first && gapStart + executionTime <= busy.first) {
+                start = gapStart;
+                break;
+            }
+            idleFrom = busy.second;
+        }
+        return start >= 0 ? start : std::max(idleFrom, readyTime);
+    }
+public:
+    /**
+     * Constructor for ReferencePlacer, with every machine free from time zero.
+     * @param _graph Workflow whose jobs are placed
+     * @param numMachines Number of machines
+     * @param _policy How the start time on a machine is chosen
+     */
+    ReferencePlacer(const CSRWorkflowGraph& _graph, int numMachines, PlacementPolicy _policy):
+        graph(_graph), policy(_policy), busyTimes(numMachines), machineFinishTimes(numMachines, 0),
+        jobMachines(_graph.getNumJobs(), -1), jobFinishTimes(_graph.getNumJobs(), 0) {}
+
+    /**
+     * @param job Id of the job, whose predecessors are placed
+     * @return Machine and start time of the job
+     */
+    Placement findPlacement(JobId job) const {
+        Placement best = {0, findStart(0, job)};
+        for (int machine = 1; machine < static_cast<int>(busyTimes.size()); machine++) {
+            int start = findStart(machine, job);
+            if (start < best.startTime) {
+                best.machine = machine;
+                best.startTime = start;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * Places a job where findPlacement() says.
+     * @param job Id of the job, whose predecessors are placed
+     * @return Scheduling information of the job
+     */
+    ScheduledJob place(JobId job) {
+        Placement placement = findPlacement(job);
+        int executionTime = graph.getExecutionTime(job), finishTime = placement.startTime + executionTime;
+        int scheduleTime = machineFinishTimes[placement.machine];
+        if (executionTime > 0 || policy == PlacementPolicy::Append) {
+            auto& busy = busyTimes[placement.machine];
+            busy.insert(std::upper_bound(busy.begin(), busy.end(), std::make_pair(placement.startTime, finishTime)),
+                        std::make_pair(placement.startTime, finishTime));
+            machineFinishTimes[placement.machine] = std::max(scheduleTime, finishTime);
+        }
+        jobMachines[job] = placement.machine;
+        jobFinishTimes[job] = finishTime;
+        makespan = std::max(makespan, finishTime);
+        return ScheduledJob(job, placement.machine, scheduleTime, placement.startTime, finishTime);
+    }
+
+    /**
+     * @return Latest finish time of the placed jobs
+     */
+    int getMakespan() const {
+        return makespan;
+    }
+};
+
+/**
+ * Schedules a workflow like DynamicListScheduler, but by evaluating the earliest start time of every ready job on
+ * every machine after every placement. The next job is the one with the highest priority, critical weight minus
+ * earliest start time for DLS and minus earliest start time for ETF, then the highest critical weight, then the
+ * smallest id.
+ * @param graph The workflow
+ * @param criticalWeights Critical weight of every job indexed by job id
+ * @param numMachines Number of machines
+ * @param placementPolicy Placement policy
+ * @param orderingPolicy DynamicLevel or EarliestTimeFirst
+ * @return Makespan and scheduled jobs
+ */
+inline std::pair<int, ScheduleOrder> referenceDynamicSchedule(const CSRWorkflowGraph& graph,
+                                                              const std::vector<int>& criticalWeights, int numMachines,
+                                                              PlacementPolicy placementPolicy, OrderingPolicy orderingPolicy) {
+    ReferencePlacer placer(graph, numMachines, placementPolicy);
+    std::vector<int> inDegrees(graph.getNumJobs());
+    std::vector<JobId> readyJobs;
+    for (JobId job = 0; job < graph.getNumJobs(); job++) {
+        inDegrees[job] = graph.getIndegree(job);
+        if (inDegrees[job] == 0) {
+            readyJobs.emplace_back(job);
+        }
+    }
+
+    ScheduleOrder scheduleOrder;
+    while (!readyJobs.empty()) {
+        size_t best = 0;
+        int bestPriority = 0;
+        for (size_t i = 0; i < readyJobs.size(); i++) {
+            JobId job = readyJobs[i], bestJob = readyJobs[best];
+            int basePriority = orderingPolicy == OrderingPolicy::EarliestTimeFirst ? 0 : criticalWeights[job];
+            int priority = basePriority - placer.findPlacement(job).startTime;
+            bool isBetter = priority != bestPriority ? priority > bestPriority
+                          : criticalWeights[job] != criticalWeights[bestJob] ? criticalWeights[job] > criticalWeights[bestJob]
+                          : job < bestJob;
+            if (i == 0 || isBetter) {
+                best = i;
+                bestPriority = priority;
+            }
+        }
+
+        JobId job = readyJobs[best];
+        readyJobs.erase(readyJobs.begin() + best);
+        scheduleOrder.emplace_back(placer.place(job));
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            if (--inDegrees[comm.job] == 0) {
+                readyJobs.emplace_back(comm.job);
+            }
+        }
+    }
+    return {placer.getMakespan(), scheduleOrder};
+}
+
+/**
+ * Compares two schedules job by job, reporting the first difference on the standard error.
+ * @param context Description of the case, printed with a difference
+ * @param expected Makespan and jobs of the reference schedule
+ * @param actual Makespan and jobs of the schedule checked
+ * @return True if the schedules are identical, false otherwise
+ */
+inline bool checkSameSchedule(const std::string& context, const std::pair<int, ScheduleOrder>& expected,
+                              const std::pair<int, ScheduleOrder>& actual) {
+    if (expected.second.size() != actual.second.size()) {
+        std::fprintf(stderr, "%s: %zu jobs scheduled, expected %zu\n", context.c_str(), actual.second.size(),
+                     expected.second.size());
+        return false;
+    }
+    for (size_t i = 0; i < expected.second.size(); i++) {
+        const ScheduledJob& e = expected.second[i];
+        const ScheduledJob& a = actual.second[i];
+        if (e.jobId != a.jobId || e.machineId != a.machineId || e.scheduleTime != a.scheduleTime ||
+            e.startTime != a.startTime || e.finishTime != a.finishTime) {
+            std::fprintf(stderr, "%s: job %zu is (%u, machine %d, %d, %d-%d), expected (%u, machine %d, %d, %d-%d)\n",
+                         context.c_str(), i, a.jobId, a.machineId, a.scheduleTime, a.startTime, a.finishTime,
+                         e.jobId, e.machineId, e.scheduleTime, e.startTime, e.finishTime);
+            return false;
+        }
+    }
+    if (expected.first != actual.first) {
+        std::fprintf(stderr, "%s: makespan %d, expected %d\n", context.c_str(), actual.first, expected.first);
+        return false;
+    }
+    return true;
+}
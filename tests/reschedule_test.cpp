@@ -0,0 +1,199 @@
+/*
+Checks WorkflowSchedule::reschedule() against schedule() on random DAGs edited
+between runs. Edits change execution times, add and remove communications,
+remove communications just added or add back those just removed, add jobs
+depending on earlier ones and add communications in bulk, so that the updated
+critical weights, the kept prefix of the topological order and the restored
+placement are all exercised, with both placement policies and every ready
+queue. A few edits are made between runs, so that the communications edited
+are merged into the CSR form in batches, and schedule() runs on a CSR form
+built from scratch to check the merged one too.
+
+Usage: reschedule_test [number of workflows] [runs per workflow]   (default: 300 20)
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "reference.h"
+
+/**
+ * Adds a random workflow to an empty graph. Communications always go from a smaller to a larger id, and so do those
+ * added by the edits, so the workflow stays acyclic.
+ * @param rng Random generator
+ * @param graph Empty workflow graph
+ * @param edges Receives the source and destination job of every communication
+ */
+static void buildWorkflow(std::mt19937& rng, WorkflowGraph& graph, std::vector<std::pair<JobId, JobId>>& edges) {
+    RandomWorkflow workflow = generateRandomWorkflow(rng);
+    for (size_t job = 0; job < workflow.executionTimes.size(); job++) {
+        graph.addJob("job" + std::to_string(job), workflow.executionTimes[job]);
+    }
+    for (size_t i = 0; i < workflow.commTimes.size(); i++) {
+        graph.addCommunication(workflow.fromJobs[i], workflow.toJobs[i], workflow.commTimes[i]);
+        edges.emplace_back(workflow.fromJobs[i], workflow.toJobs[i]);
+    }
+}
+
+/**
+ * Builds the CSR form of a workflow from scratch, from its jobs and communications.
+ * @param graph The workflow
+ * @return CSR form of the workflow
+ */
+static CSRWorkflowGraph buildFrozen(const WorkflowGraph& graph) {
+    std::vector<int> executionTimes;
+    for (JobId job = 0; job < graph.getNumJobs(); job++) {
+        executionTimes.emplace_back(graph.getJob(job)->executionTime);
+    }
+    std::vector<JobId> fromJobs, toJobs;
+    std::vector<int> commTimes;
+    for (CommunicationId id = 0; id < graph.getNumCommunications(); id++) {
+        const Communication& comm = graph.getCommunication(id);
+        fromJobs.emplace_back(comm.fromJob);
+        toJobs.emplace_back(comm.toJob);
+        commTimes.emplace_back(comm.commTime);
+    }
+    return CSRWorkflowGraph(executionTimes.size(), executionTimes.data(), commTimes.size(), fromJobs.data(),
+                            toJobs.data(), commTimes.data());
+}
+
+/**
+ * Compares two CSR forms of a workflow, reporting the first difference on the standard error.
+ * @param context Description of the case, printed with a difference
+ * @param expected CSR form built from scratch
+ * @param actual CSR form checked
+ * @return True if both have the same jobs and the same communications in the same order, false otherwise
+ */
+static bool checkSameGraph(const std::string& context, const CSRWorkflowGraph& expected, const CSRWorkflowGraph& actual) {
+    auto isSame = [](Span<CSREdge> a, Span<CSREdge> b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const CSREdge& x, const CSREdge& y) {
+            return x.job == y.job && x.commTime == y.commTime;
+        });
+    };
+    if (expected.getNumJobs() != actual.getNumJobs() || expected.getNumCommunications() != actual.getNumCommunications()) {
+        std::fprintf(stderr, "%s: CSR form has %zu jobs and %zu communications, expected %zu and %zu\n", context.c_str(),
+                     actual.getNumJobs(), actual.getNumCommunications(), expected.getNumJobs(),
+                     expected.getNumCommunications());
+        return false;
+    }
+    for (JobId job = 0; job < expected.getNumJobs(); job++) {
+        if (expected.getExecutionTime(job) != actual.getExecutionTime(job) ||
+            !isSame(expected.getOutEdges(job), actual.getOutEdges(job)) || !isSame(expected.getInEdges(job), actual.getInEdges(job))) {
+            std::fprintf(stderr, "%s: job %u differs in the CSR form\n", context.c_str(), job);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Applies a random edit to a workflow.
+ * @param rng Random generator
+ * @param graph The workflow
+ * @param edges Source and destination job of every communication, updated with the edit
+ */
+static void editWorkflow(std::mt19937& rng, WorkflowGraph& graph, std::vector<std::pair<JobId, JobId>>& edges) {
+    JobId numJobs = graph.getNumJobs();
+    JobId from = rng() % numJobs, to = rng() % numJobs;
+    if (from > to) {
+        std::swap(from, to);
+    }
+    switch (rng() % 6) {
+    case 0:
+        graph.setExecutionTime(rng() % numJobs, rng() % 7);
+        break;
+    case 1:
+        if (from < to) {
+            graph.addCommunication(from, to, rng() % 9);
+            edges.emplace_back(from, to);
+        }
+        break;
+    case 2:
+        if (!edges.empty()) {
+            std::pair<JobId, JobId> edge = edges[rng() % edges.size()];
+            graph.removeCommunication(edge.first, edge.second);
+            edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
+        }
+        break;
+    case 3: {
+        JobId job = graph.addJob("job" + std::to_string(numJobs), rng() % 7);
+        for (int i = rng() % 3; i > 0; i--) {
+            JobId predecessor = rng() % numJobs;
+            graph.addCommunication(predecessor, job, rng() % 9);
+            edges.emplace_back(predecessor, job);
+        }
+        break;
+    }
+    case 4:
+        // a communication removed right after being added, or added back right after being removed
+        if (from < to) {
+            graph.addCommunication(from, to, rng() % 9);
+            graph.removeCommunication(from, to);
+            edges.erase(std::remove(edges.begin(), edges.end(), std::make_pair(from, to)), edges.end());
+        } else if (!edges.empty()) {
+            std::pair<JobId, JobId> edge = edges[rng() % edges.size()];
+            graph.removeCommunication(edge.first, edge.second);
+            graph.addCommunication(edge.first, edge.second, rng() % 9);
+            edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
+            edges.emplace_back(edge);
+        }
+        break;
+    default:
+        if (from < to) {
+            JobId fromJobs[] = {from, from};
+            JobId toJobs[] = {to, to};
+            int commTimes[] = {static_cast<int>(rng() % 9), static_cast<int>(rng() % 9)};
+            graph.addCommunications(2, fromJobs, toJobs, commTimes);
+            edges.emplace_back(from, to);
+            edges.emplace_back(from, to);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int numWorkflows = argc > 1 ? std::atoi(argv[1]) : 300;
+    int numRuns = argc > 2 ? std::atoi(argv[2]) : 20;
+    const PlacementPolicy policies[] = {PlacementPolicy::Append, PlacementPolicy::Insertion};
+    const char* policyNames[] = {"append", "insertion"};
+    const ReadyQueueType queues[] = {ReadyQueueType::BinaryHeap, ReadyQueueType::DaryHeap, ReadyQueueType::RadixHeap};
+
+    std::mt19937 rng(16);
+    int numFailures = 0;
+    for (int seed = 0; seed < numWorkflows; seed++) {
+        int numMachines = 1 + rng() % 6;
+        ReadyQueueType queue = queues[rng() % 3];
+        for (int p = 0; p < 2; p++) {
+            WorkflowGraph graph;
+            std::vector<std::pair<JobId, JobId>> edges;
+            buildWorkflow(rng, graph, edges);
+            WorkflowSchedule incremental(&graph, numMachines);
+            incremental.setPlacementPolicy(policies[p]);
+            incremental.setReadyQueue(queue);
+
+            for (int run = 0; run <= numRuns; run++) {
+                for (int edit = run > 0 ? 1 + rng() % 4 : 0; edit > 0; edit--) {
+                    editWorkflow(rng, graph, edges);
+                }
+                int makespan = incremental.reschedule();
+                CSRWorkflowGraph frozen = buildFrozen(graph);
+                WorkflowSchedule fresh(&frozen, numMachines);
+                fresh.setPlacementPolicy(policies[p]);
+                fresh.setReadyQueue(queue);
+                std::string context = "workflow " + std::to_string(seed) + ", " + std::to_string(numMachines) +
+                                      " machines, " + policyNames[p] + ", run " + std::to_string(run);
+                if (!checkSameGraph(context, frozen, graph.freeze()) ||
+                    !checkSameSchedule(context, fresh.schedule(), {makespan, incremental.getScheduleOrder()})) {
+                    numFailures++;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::printf("reschedule_test: %d workflows with %d runs, %d failures\n", numWorkflows, numRuns, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+/*
+Checks the parallel topological sorts on 1, 2 and many threads. The
+deterministic sort must give exactly the order of the serial sort, whether it
+sorts by priority or falls back to the serial sort because of jobs of zero
+length. The sort by level must give a valid topological order, sorted by
+decreasing critical weight, then increasing level and id, whatever the number
+of threads. Both are run on the synthetic DAG families of the benchmarks, whose
+Montage and FFT levels are distributed over the threads, and on small random
+workflows. Both sorts are also checked against std::sort on random weights
+including INT_MIN, negative values and INT_MAX.
+
+Usage: topological_test [number of random workflows]   (default: 500)
+*/
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "../bench/generators.h"
+#include "reference.h"
+
+/**
+ * Compares two orders of jobs, reporting the first difference on the standard error.
+ * @param context Description of the case, printed with a difference
+ * @param expected Expected order
+ * @param actual Order checked
+ * @return True if the orders are identical, false otherwise
+ */
+static bool checkSameOrder(const std::string& context, const std::vector<JobId>& expected,
+                           const std::vector<JobId>& actual) {
+    if (expected.size() != actual.size()) {
+        std::fprintf(stderr, "%s: %zu jobs sorted, expected %zu\n", context.c_str(), actual.size(), expected.size());
+        return false;
+    }
+    auto mismatch = std::mismatch(expected.begin(), expected.end(), actual.begin());
+    if (mismatch.first != expected.end()) {
+        std::fprintf(stderr, "%s: job %zu of the order is %u, expected %u\n", context.c_str(),
+                     static_cast<size_t>(mismatch.first - expected.begin()), *mismatch.second, *mismatch.first);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Sorts jobs like sortByLevelAndCriticality() with std::sort: by decreasing critical weight, then by increasing level
+ * and id, the level of a job being the number of jobs on the longest path from an entry job to it.
+ * @param graph The workflow, acyclic
+ * @param criticalWeights Critical weight of every job indexed by job id
+ * @return Vector of job ids in that order
+ */
+static std::vector<JobId> referenceSortByLevel(const CSRWorkflowGraph& graph, const std::vector<int>& criticalWeights) {
+    std::vector<int> inDegrees(graph.getNumJobs());
+    std::vector<JobId> order;
+    for (JobId job = 0; job < graph.getNumJobs(); job++) {
+        inDegrees[job] = graph.getIndegree(job);
+        if (inDegrees[job] == 0) {
+            order.emplace_back(job);
+        }
+    }
+    std::vector<uint32_t> levels(graph.getNumJobs(), 0);
+    for (size_t head = 0; head < order.size(); head++) {
+        for (const CSREdge& comm: graph.getOutEdges(order[head])) {
+            levels[comm.job] = std::max(levels[comm.job], levels[order[head]] + 1);
+            if (--inDegrees[comm.job] == 0) {
+                order.emplace_back(comm.job);
+            }
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](JobId a, JobId b) {
+        return std::make_tuple(-static_cast<int64_t>(criticalWeights[a]), levels[a], a) <
+               std::make_tuple(-static_cast<int64_t>(criticalWeights[b]), levels[b], b);
+    });
+    return order;
+}
+
+/**
+ * Checks that an order holds every job once and that every communication goes forward in it.
+ * @param context Description of the case, printed with a violation
+ * @param graph The workflow
+ * @param order Order of the jobs
+ * @return True if the order is a topological order of the workflow, false otherwise
+ */
+static bool checkTopological(const std::string& context, const CSRWorkflowGraph& graph, const std::vector<JobId>& order) {
+    std::vector<size_t> positions(graph.getNumJobs(), SIZE_MAX);
+    for (size_t i = 0; i < order.size(); i++) {
+        if (order[i] >= positions.size() || positions[order[i]] != SIZE_MAX) {
+            std::fprintf(stderr, "%s: job %u is missing or repeated\n", context.c_str(), order[i]);
+            return false;
+        }
+        positions[order[i]] = i;
+    }
+    for (JobId job = 0; job < graph.getNumJobs(); job++) {
+        for (const CSREdge& comm: graph.getOutEdges(job)) {
+            if (positions[job] == SIZE_MAX || positions[comm.job] == SIZE_MAX || positions[job] >= positions[comm.job]) {
+                std::fprintf(stderr, "%s: job %u is not sorted before its successor %u\n", context.c_str(), job,
+                             comm.job);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks both parallel sorts of a workflow on every pool.
+ * @param context Description of the case, printed with a difference
+ * @param graph The workflow
+ * @param pools Thread pools to sort with
+ * @return Number of sorts that failed
+ */
+static int checkSorts(const std::string& context, const CSRWorkflowGraph& graph, std::vector<ThreadPool*>& pools) {
+    WorkflowSchedule serialSchedule(&graph, 1);
+    std::vector<int> criticalWeights = serialSchedule.getCriticalWeights();
+    std::vector<JobId> serialOrder = serialSchedule.topologicalSort(criticalWeights);
+    std::vector<JobId> levelOrder = referenceSortByLevel(graph, criticalWeights);
+    int numFailures = 0;
+    for (ThreadPool* pool: pools) {
+        std::string poolContext = context + ", " + std::to_string(pool->getNumThreads()) + " threads";
+        WorkflowSchedule schedule(&graph, 1);
+        schedule.setThreadPool(pool);
+        schedule.setParallelTopologicalSort(true, true);
+        numFailures += !checkSameOrder(poolContext + ", deterministic", serialOrder, schedule.topologicalSort(criticalWeights));
+
+        schedule.setParallelTopologicalSort(true, false);
+        std::vector<JobId> order = schedule.topologicalSort(criticalWeights);
+        numFailures += !checkTopological(poolContext + ", by level", graph, order) ||
+                       !checkSameOrder(poolContext + ", by level", levelOrder, order);
+    }
+    return numFailures;
+}
+
+int main(int argc, char** argv) {
+    int numWorkflows = argc > 1 ? std::atoi(argv[1]) : 500;
+    ThreadPool onePool(1), twoPool(2), manyPool(std::max(4u, std::thread::hardware_concurrency()));
+    std::vector<ThreadPool*> pools = {&onePool, &twoPool, &manyPool};
+
+    int numChecked = 0, numFailures = 0;
+    for (size_t family = 0; family < sizeof(GRAPH_FAMILY_NAMES) / sizeof(GRAPH_FAMILY_NAMES[0]); family++) {
+        for (uint32_t seed = 1; seed <= 2; seed++) {
+            GeneratorOptions options;
+            options.seed = seed;
+            CSRWorkflowGraph graph = generateWorkflow(static_cast<GraphFamily>(family), options).freeze();
+            numFailures += checkSorts(std::string(GRAPH_FAMILY_NAMES[family]) + ", seed " + std::to_string(seed), graph, pools);
+            numChecked++;
+        }
+    }
+
+    std::mt19937 rng(13);
+    for (int seed = 0; seed < numWorkflows; seed++) {
+        CSRWorkflowGraph graph = generateRandomWorkflow(rng).freeze();
+        numFailures += checkSorts("workflow " + std::to_string(seed), graph, pools);
+        numChecked++;
+    }
+
+    // both sorts on arbitrary weights of a graph without communications, where every level is 0
+    const int special[] = {INT_MIN, INT_MIN + 1, -1, 0, 1, INT_MAX - 1, INT_MAX};
+    for (int seed = 0; seed < 100; seed++) {
+        std::vector<int> weights(1 + rng() % 10000);
+        for (int& weight: weights) {
+            weight = rng() % 2 == 0 ? special[rng() % 7] : static_cast<int>(rng());
+        }
+        std::vector<int> executionTimes(weights.size(), 1);
+        CSRWorkflowGraph graph(executionTimes.size(), executionTimes.data(), 0, nullptr, nullptr, nullptr);
+        std::vector<JobId> expected(weights.size());
+        for (JobId job = 0; job < expected.size(); job++) {
+            expected[job] = job;
+        }
+        std::stable_sort(expected.begin(), expected.end(), [&](JobId a, JobId b) {
+            return weights[a] > weights[b];
+        });
+        for (ThreadPool* pool: pools) {
+            std::string context = "weights " + std::to_string(seed) + ", " + std::to_string(pool->getNumThreads()) + " threads";
+            numFailures += !checkSameOrder(context + ", by criticality", expected, sortByCriticality(weights, *pool)) ||
+                           !checkSameOrder(context + ", by level", expected, sortByLevelAndCriticality(graph, weights, *pool));
+        }
+        numChecked++;
+    }
+
+    std::printf("topological_test: %d workflows, %d failures\n", numChecked, numFailures);
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}